@@ -4,13 +4,25 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 
+#include "ue_mux.h"
+
 #define PORT 8080
 #define BUFFER_SIZE 1024
 
+// client [num_ues]: one UE, or num_ues UEs multiplexed on this connection (gnb_server only),
+// whose grant PDUs are split up and reported per UE
 int main(int argc, char *argv[]) {
     int sock;
     struct sockaddr_in server;
     char server_reply[BUFFER_SIZE];
+    int num_ues = argc > 1 ? atoi(argv[1]) : 1;
+    int first_ue = -1;
+    long *granted_rbs = NULL;
+
+    if (num_ues < 1 || num_ues > MUX_MAX_UES) {
+        fprintf(stderr, "Between 1 and %d UEs per connection\n", MUX_MAX_UES);
+        return 1;
+    }
 
     sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock == -1) {
@@ -30,21 +42,65 @@ int main(int argc, char *argv[]) {
     }
     printf("Connected to server\n");
 
-    // Receive server replies
+    if (num_ues > 1) {
+        char hello[32];
+        snprintf(hello, sizeof(hello), "MUX %d", num_ues);
+        send(sock, hello, strlen(hello) + 1, 0);
+        granted_rbs = calloc(num_ues, sizeof(long));
+    }
+
+    // Receive server replies; messages are NUL-terminated and may arrive split or coalesced
+    int pending = 0;
     while (1) {
-        int recv_len = recv(sock, server_reply, BUFFER_SIZE, 0);
-        if (recv_len > 0) {
-            server_reply[recv_len] = '\0';
-            printf("Server reply: %s\n", server_reply);
-        } else if (recv_len == 0) {
+        int recv_len = recv(sock, server_reply + pending, BUFFER_SIZE - 1 - pending, 0);
+        if (recv_len == 0) {
             printf("Server disconnected\n");
             break;
-        } else {
+        } else if (recv_len < 0) {
             perror("Receive failed");
             break;
         }
+        pending += recv_len;
+        server_reply[pending] = '\0';
+
+        int start = 0;
+        for (int i = 0; i < pending; i++) {
+            if (server_reply[i] != '\0') {
+                continue;
+            }
+            const char *message = server_reply + start;
+            start = i + 1;
+
+            int ues[MUX_PDU_SIZE / 4], rbs[MUX_PDU_SIZE / 4], count;
+            long tti;
+            long long tti_start;
+            if (num_ues > 1 && sscanf(message, "MUX first=%d n=%d", &first_ue, &count) == 2) {
+                printf("Carrying UEs %d to %d\n", first_ue, first_ue + count - 1);
+                continue;
+            }
+            count = mux_parse_grants(message, &tti, &tti_start, ues, rbs, MUX_PDU_SIZE / 4);
+            if (count < 0 || first_ue < 0) {
+                printf("Server reply: %s\n", message);
+                continue;
+            }
+            for (int g = 0; g < count; g++) {
+                int local = ues[g] - first_ue;
+                if (local < 0 || local >= num_ues) {
+                    printf("Grant for UE %d, which is not on this connection\n", ues[g]);
+                    continue;
+                }
+                granted_rbs[local] += rbs[g];
+                printf("UE %d: %d RBs tti=%ld (%ld in total)\n", ues[g], rbs[g], tti, granted_rbs[local]);
+            }
+        }
+        memmove(server_reply, server_reply + start, pending - start);
+        pending -= start;
+        if (pending == BUFFER_SIZE - 1) {
+            pending = 0;
+        }
     }
 
+    free(granted_rbs);
     close(sock);
     return 0;
 }
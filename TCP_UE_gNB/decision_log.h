@@ -0,0 +1,310 @@
+#ifndef DECISION_LOG_H
+#define DECISION_LOG_H
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sched_plugin.h"
+
+// Append-only log of every TTI's scheduler inputs and decisions, written through a memory
+// mapping so the TTI thread only copies bytes: the file is mapped DECISION_LOG_WINDOW bytes
+// at a time. A mapper thread (decision_log_start_mapper) keeps the next window mapped and
+// faulted in and unmaps the full ones, so when a window fills up the writer just switches
+// to the spare; the ftruncate, mmap, page faults (which mlockall would otherwise take all at
+// once inside mmap) and munmap stay off the TTI thread.
+// If the server dies, everything written so far is in the page cache and reaches the file.
+//
+// Layout: a decision_log_header_t, then 8-byte aligned records, each a decision_log_record_t
+// followed by its payload:
+//   DECISION_LOG_TTI     sched_ue_t[num_ues] (the policy's input), then sched_grant_t[num_grants]
+//                        (the grants actually sent: no 0-RB grants, none if the policy's
+//                        were rejected)
+//   DECISION_LOG_POLICY  the name of the policy used from this TTI on, 32 bytes
+// A record never crosses a window boundary; a zero length means skip to the next window,
+// which is also how an unfinished log ends.
+
+#define DECISION_LOG_MAGIC "GDLG"
+#define DECISION_LOG_VERSION 1
+#define DECISION_LOG_WINDOW (16L << 20)
+#define DECISION_LOG_POLICY_NAME 32
+
+enum { DECISION_LOG_TTI = 1, DECISION_LOG_POLICY = 2 };
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    int64_t tti_us;
+    int32_t resource_blocks;
+    int32_t max_grants;
+    int64_t reserved;
+} decision_log_header_t;
+
+typedef struct {
+    uint32_t bytes;         // whole record, header included
+    uint32_t type;
+    int64_t tti;
+    int64_t tti_start_ns;
+    int32_t num_ues;
+    int32_t num_grants;
+} decision_log_record_t;
+
+typedef struct {
+    int fd;
+    char *window;
+    long window_offset;     // file offset of window
+    long used;              // bytes written in window
+    long long records;
+    long late_windows;      // times the writer had to wait for the spare window
+    // The writer takes spare and leaves the window it filled in retired, then posts refill;
+    // the mapper unmaps retired and maps the window after spare. Exactly one refill is
+    // outstanding at a time, so the mapper can track the offset on its own.
+    _Atomic(char *) spare;
+    _Atomic(char *) retired;
+    long spare_offset;      // mapper's: file offset of the next window it maps
+    sem_t refill;
+    atomic_int stopping;
+    int mapper_running;
+    pthread_t mapper;
+} decision_log_t;
+
+static inline char *decision_log_map(decision_log_t *log, long offset) {
+    // Keep the file a window ahead of the one written, so a page fault never lands past its end
+    if (ftruncate(log->fd, offset + DECISION_LOG_WINDOW) != 0) {
+        perror("Failed to grow decision log");
+        exit(EXIT_FAILURE);
+    }
+    char *window = mmap(NULL, DECISION_LOG_WINDOW, PROT_READ | PROT_WRITE, MAP_SHARED, log->fd, offset);
+    if (window == MAP_FAILED) {
+        perror("Failed to map decision log");
+        exit(EXIT_FAILURE);
+    }
+    // Even under mlockall a shared mapping is only populated for reading, so the first write
+    // to each page would still fault: write every page once here
+    volatile char *pages = window;
+    long page = sysconf(_SC_PAGESIZE);
+    for (long position = 0; position < DECISION_LOG_WINDOW; position += page) {
+        pages[position] = 0;
+    }
+    return window;
+}
+
+static inline void *decision_log_mapper(void *arg) {
+    decision_log_t *log = arg;
+    while (1) {
+        while (sem_wait(&log->refill) != 0) {
+        }
+        char *retired = atomic_exchange(&log->retired, NULL);
+        if (retired != NULL) {
+            munmap(retired, DECISION_LOG_WINDOW);
+        }
+        if (atomic_load(&log->stopping)) {
+            return NULL;
+        }
+        char *window = decision_log_map(log, log->spare_offset);
+        log->spare_offset += DECISION_LOG_WINDOW;
+        atomic_store(&log->spare, window);
+    }
+}
+
+static inline void decision_log_open(decision_log_t *log, const char *path, long tti_us, int resource_blocks,
+                                     int max_grants) {
+    log->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (log->fd < 0) {
+        perror("Failed to create decision log");
+        exit(EXIT_FAILURE);
+    }
+    log->records = 0;
+    log->late_windows = 0;
+    log->window = decision_log_map(log, 0);
+    log->window_offset = 0;
+    atomic_store(&log->spare, decision_log_map(log, DECISION_LOG_WINDOW));
+    atomic_store(&log->retired, NULL);
+    log->spare_offset = 2 * DECISION_LOG_WINDOW;
+    atomic_store(&log->stopping, 0);
+    log->mapper_running = 0;
+    sem_init(&log->refill, 0, 0);
+    decision_log_header_t header = {{0}, DECISION_LOG_VERSION, tti_us, resource_blocks, max_grants, 0};
+    memcpy(header.magic, DECISION_LOG_MAGIC, 4);
+    memcpy(log->window, &header, sizeof(header));
+    log->used = sizeof(header);
+}
+
+// Starts the mapper thread; call it once the thread may be created (after rt_reserve_cpu).
+// Without a mapper the writer maps the next window itself.
+static inline void decision_log_start_mapper(decision_log_t *log) {
+    if (pthread_create(&log->mapper, NULL, decision_log_mapper, log) != 0) {
+        fprintf(stderr, "Failed to start the decision log mapper\n");
+        exit(EXIT_FAILURE);
+    }
+    log->mapper_running = 1;
+}
+
+// Moves the writer to the spare window and gets the one after it mapped
+static inline void decision_log_next_window(decision_log_t *log) {
+    if (log->mapper_running) {
+        char *spare;
+        if (atomic_load(&log->spare) == NULL) {
+            log->late_windows++;
+        }
+        while ((spare = atomic_exchange(&log->spare, NULL)) == NULL) {
+            usleep(50);     // the mapper may share the CPU with this thread
+        }
+        atomic_store(&log->retired, log->window);
+        sem_post(&log->refill);
+        log->window = spare;
+    } else {
+        munmap(log->window, DECISION_LOG_WINDOW);
+        log->window = atomic_exchange(&log->spare, NULL);
+        atomic_store(&log->spare, decision_log_map(log, log->spare_offset));
+        log->spare_offset += DECISION_LOG_WINDOW;
+    }
+    log->window_offset += DECISION_LOG_WINDOW;
+    log->used = 0;
+}
+
+// Room for a record of bytes (8-byte aligned) in the current window
+static inline char *decision_log_reserve(decision_log_t *log, uint32_t bytes) {
+    if (log->used + bytes > DECISION_LOG_WINDOW) {
+        if (bytes > DECISION_LOG_WINDOW) {
+            fprintf(stderr, "Decision log record of %u bytes does not fit a window\n", bytes);
+            exit(EXIT_FAILURE);
+        }
+        decision_log_next_window(log);
+    }
+    char *record = log->window + log->used;
+    log->used += bytes;
+    log->records++;
+    return record;
+}
+
+// Drops the 0-RB grants, which are never sent, keeping the order; returns how many are left
+static inline int decision_log_sent_grants(sched_grant_t *grants, int count) {
+    int sent = 0;
+    for (int g = 0; g < count; g++) {
+        if (grants[g].resource_blocks > 0) {
+            grants[sent++] = grants[g];
+        }
+    }
+    return sent;
+}
+
+static inline void decision_log_tti(decision_log_t *log, long tti, long long tti_start_ns, const sched_ue_t *ues,
+                                    int num_ues, const sched_grant_t *grants, int num_grants) {
+    size_t ue_bytes = num_ues * sizeof(sched_ue_t);
+    size_t grant_bytes = num_grants * sizeof(sched_grant_t);
+    uint32_t bytes = (sizeof(decision_log_record_t) + ue_bytes + grant_bytes + 7) & ~7u;
+    char *record = decision_log_reserve(log, bytes);
+    decision_log_record_t header = {bytes, DECISION_LOG_TTI, tti, tti_start_ns, num_ues, num_grants};
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), ues, ue_bytes);
+    memcpy(record + sizeof(header) + ue_bytes, grants, grant_bytes);
+}
+
+static inline void decision_log_policy(decision_log_t *log, long tti, const char *name) {
+    uint32_t bytes = sizeof(decision_log_record_t) + DECISION_LOG_POLICY_NAME;
+    char *record = decision_log_reserve(log, bytes);
+    decision_log_record_t header = {bytes, DECISION_LOG_POLICY, tti, 0, 0, 0};
+    memcpy(record, &header, sizeof(header));
+    snprintf(record + sizeof(header), DECISION_LOG_POLICY_NAME, "%s", name);
+}
+
+// Stops the mapper and trims the file to what was written
+static inline void decision_log_close(decision_log_t *log) {
+    long length = log->window_offset + log->used;
+    if (log->mapper_running) {
+        atomic_store(&log->stopping, 1);
+        sem_post(&log->refill);
+        pthread_join(log->mapper, NULL);
+        log->mapper_running = 0;
+    }
+    char *spare = atomic_exchange(&log->spare, NULL);
+    if (spare != NULL) {
+        munmap(spare, DECISION_LOG_WINDOW);
+    }
+    munmap(log->window, DECISION_LOG_WINDOW);
+    if (ftruncate(log->fd, length) != 0) {
+        perror("Failed to trim decision log");
+    }
+    close(log->fd);
+}
+
+// Reading: the whole file is mapped read-only and walked record by record
+typedef struct {
+    const char *data;
+    long length;
+    long position;
+    decision_log_header_t header;
+} decision_log_reader_t;
+
+static inline void decision_log_read_open(decision_log_reader_t *reader, const char *path) {
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        perror("Failed to open decision log");
+        exit(EXIT_FAILURE);
+    }
+    reader->length = info.st_size;
+    if (reader->length < (long)sizeof(decision_log_header_t)) {
+        fprintf(stderr, "%s is not a decision log\n", path);
+        exit(EXIT_FAILURE);
+    }
+    reader->data = mmap(NULL, reader->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (reader->data == MAP_FAILED) {
+        perror("Failed to map decision log");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(&reader->header, reader->data, sizeof(reader->header));
+    if (memcmp(reader->header.magic, DECISION_LOG_MAGIC, 4) != 0 || reader->header.version != DECISION_LOG_VERSION) {
+        fprintf(stderr, "%s is not a version %d decision log\n", path, DECISION_LOG_VERSION);
+        exit(EXIT_FAILURE);
+    }
+    reader->position = sizeof(decision_log_header_t);
+}
+
+static inline void decision_log_rewind(decision_log_reader_t *reader) {
+    reader->position = sizeof(decision_log_header_t);
+}
+
+// Returns the next record, or NULL at the end of the log
+static inline const decision_log_record_t *decision_log_next(decision_log_reader_t *reader) {
+    while (reader->position + (long)sizeof(decision_log_record_t) <= reader->length) {
+        const decision_log_record_t *record = (const decision_log_record_t *)(reader->data + reader->position);
+        if (record->bytes == 0) {
+            reader->position = (reader->position / DECISION_LOG_WINDOW + 1) * DECISION_LOG_WINDOW;
+            continue;
+        }
+        if (record->bytes < sizeof(decision_log_record_t) + (uint64_t)record->num_ues * sizeof(sched_ue_t) +
+                                (uint64_t)record->num_grants * sizeof(sched_grant_t) ||
+            record->num_ues < 0 || record->num_grants < 0 || reader->position + record->bytes > reader->length) {
+            fprintf(stderr, "Decision log is corrupt at offset %ld\n", reader->position);
+            return NULL;
+        }
+        reader->position += record->bytes;
+        return record;
+    }
+    return NULL;
+}
+
+static inline const sched_ue_t *decision_log_ues(const decision_log_record_t *record) {
+    return (const sched_ue_t *)(record + 1);
+}
+
+static inline const sched_grant_t *decision_log_grants(const decision_log_record_t *record) {
+    return (const sched_grant_t *)((const char *)(record + 1) + record->num_ues * sizeof(sched_ue_t));
+}
+
+static inline void decision_log_read_close(decision_log_reader_t *reader) {
+    munmap((void *)reader->data, reader->length);
+}
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef DRX_H
+#define DRX_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer_wheel.h"
+
+// Per-UE timers shared by the servers, all kept in one timer_wheel_t so a TTI only touches
+// the UEs whose timers expire in it:
+//   wake          start of the UE's DRX cycle: it wakes up for the on-duration
+//   on-duration   end of the on-duration: the UE goes back to sleep unless inactivity runs
+//   inactivity    restarted by every grant; keeps a busy UE awake past its on-duration
+//   SR timeout    an awake UE that has gone sr_timeout TTIs without a grant is starved
+// Awake UEs are kept in a dense set that the schedulers scan instead of every client slot,
+// so per-TTI work follows the awake UEs rather than the connected ones. With cycle 0 DRX is
+// off and connected UEs stay awake; with sr_timeout 0 there is no SR timer.
+//
+// UEs are the server's client slot indices. Callers hold the clients mutex.
+
+#define DRX_CYCLE_TTIS 40          // a typical drx_cycle; the servers default to 0 (off)
+#define DRX_ON_DURATION_TTIS 8
+#define DRX_INACTIVITY_TTIS 20
+
+enum { DRX_TIMER_WAKE, DRX_TIMER_ON_DURATION, DRX_TIMER_INACTIVITY, DRX_TIMER_SR, DRX_TIMERS };
+
+typedef struct {
+    timer_wheel_t wheel;
+    int cycle;
+    int on_duration;
+    int inactivity;
+    int sr_timeout;
+    int num_awake;
+    int *awake;             // awake UEs, unordered
+    int *awake_pos;         // per UE: index in awake, -1 when asleep or not connected
+    unsigned char *starved;
+    int *expired;
+} drx_t;
+
+static inline void drx_init(drx_t *drx, int capacity, int cycle, int sr_timeout) {
+    if (cycle < 0 || (cycle > 0 && cycle <= DRX_ON_DURATION_TTIS)) {
+        fprintf(stderr, "DRX cycle must be 0 (off) or longer than the %d-TTI on-duration\n", DRX_ON_DURATION_TTIS);
+        exit(EXIT_FAILURE);
+    }
+    timer_wheel_init(&drx->wheel, capacity * DRX_TIMERS, 0);
+    drx->cycle = cycle;
+    drx->on_duration = DRX_ON_DURATION_TTIS;
+    drx->inactivity = DRX_INACTIVITY_TTIS;
+    drx->sr_timeout = sr_timeout;
+    drx->num_awake = 0;
+    drx->awake = malloc(capacity * sizeof(int));
+    drx->awake_pos = malloc(capacity * sizeof(int));
+    drx->starved = calloc(capacity, 1);
+    drx->expired = malloc(capacity * DRX_TIMERS * sizeof(int));
+    if (!drx->awake || !drx->awake_pos || !drx->starved || !drx->expired) {
+        perror("Failed to allocate DRX state");
+        exit(EXIT_FAILURE);
+    }
+    for (int ue = 0; ue < capacity; ue++) {
+        drx->awake_pos[ue] = -1;
+    }
+}
+
+static inline void drx_free(drx_t *drx) {
+    timer_wheel_free(&drx->wheel);
+    free(drx->awake);
+    free(drx->awake_pos);
+    free(drx->starved);
+    free(drx->expired);
+}
+
+static inline void drx_arm(drx_t *drx, int ue, int timer, long delay) {
+    timer_wheel_arm(&drx->wheel, ue * DRX_TIMERS + timer, drx->wheel.now + delay);
+}
+
+static inline int drx_running(const drx_t *drx, int ue, int timer) {
+    return timer_wheel_armed(&drx->wheel, ue * DRX_TIMERS + timer);
+}
+
+static inline void drx_wake(drx_t *drx, int ue) {
+    if (drx->awake_pos[ue] >= 0) {
+        return;
+    }
+    drx->awake_pos[ue] = drx->num_awake;
+    drx->awake[drx->num_awake++] = ue;
+    drx->starved[ue] = 0;
+    if (drx->sr_timeout > 0) {
+        drx_arm(drx, ue, DRX_TIMER_SR, drx->sr_timeout);
+    }
+}
+
+static inline void drx_sleep(drx_t *drx, int ue) {
+    int pos = drx->awake_pos[ue];
+    if (pos < 0) {
+        return;
+    }
+    int last = drx->awake[--drx->num_awake];
+    drx->awake[pos] = last;
+    drx->awake_pos[last] = pos;
+    drx->awake_pos[ue] = -1;
+    drx->starved[ue] = 0;
+    timer_wheel_cancel(&drx->wheel, ue * DRX_TIMERS + DRX_TIMER_SR);
+}
+
+// A newly connected UE starts awake with its inactivity timer running; its cycle starts
+// at a random offset so the UEs' on-durations are spread out
+static inline void drx_attach(drx_t *drx, int ue) {
+    drx_wake(drx, ue);
+    if (drx->cycle > 0) {
+        drx_arm(drx, ue, DRX_TIMER_INACTIVITY, drx->inactivity);
+        drx_arm(drx, ue, DRX_TIMER_WAKE, 1 + rand() % drx->cycle);
+    }
+}
+
+static inline void drx_detach(drx_t *drx, int ue) {
+    drx_sleep(drx, ue);
+    for (int timer = 0; timer < DRX_TIMERS; timer++) {
+        timer_wheel_cancel(&drx->wheel, ue * DRX_TIMERS + timer);
+    }
+}
+
+static inline void drx_granted(drx_t *drx, int ue) {
+    drx->starved[ue] = 0;
+    if (drx->sr_timeout > 0) {
+        drx_arm(drx, ue, DRX_TIMER_SR, drx->sr_timeout);
+    }
+    if (drx->cycle > 0) {
+        drx_arm(drx, ue, DRX_TIMER_INACTIVITY, drx->inactivity);
+    }
+}
+
+// Runs the timers due up to and including TTI tti
+static inline void drx_tick(drx_t *drx, long tti) {
+    int count = timer_wheel_advance(&drx->wheel, tti, drx->expired);
+    for (int e = 0; e < count; e++) {
+        int ue = drx->expired[e] / DRX_TIMERS;
+        switch (drx->expired[e] % DRX_TIMERS) {
+        case DRX_TIMER_WAKE:
+            drx_arm(drx, ue, DRX_TIMER_WAKE, drx->cycle);
+            drx_arm(drx, ue, DRX_TIMER_ON_DURATION, drx->on_duration);
+            drx_wake(drx, ue);
+            break;
+        case DRX_TIMER_ON_DURATION:
+            if (!drx_running(drx, ue, DRX_TIMER_INACTIVITY)) {
+                drx_sleep(drx, ue);
+            }
+            break;
+        case DRX_TIMER_INACTIVITY:
+            if (!drx_running(drx, ue, DRX_TIMER_ON_DURATION)) {
+                drx_sleep(drx, ue);
+            }
+            break;
+        case DRX_TIMER_SR:
+            if (drx->awake_pos[ue] >= 0) {
+                drx->starved[ue] = 1;
+            }
+            break;
+        }
+    }
+}
+
+#endif
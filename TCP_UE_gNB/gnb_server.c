@@ -0,0 +1,472 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "../mac_schedule/perf_counters.h"
+#include "decision_log.h"
+#include "drx.h"
+#include "policy_loader.h"
+#include "rt_profile.h"
+#include "tti_clock.h"
+#include "ue_mux.h"
+
+// gNB server whose scheduling policy is a plugin (sched_plugin.h) that can be replaced while
+// UEs stay connected. A control thread reads commands from stdin:
+//   load <plugin.so>    load a policy and switch to it at the next TTI boundary
+// Loading (dlopen, symbol lookup, ABI check, state allocation) happens on the control
+// thread; the TTI thread only picks up the new policy pointer at the start of a TTI and hands
+// the old one back, so a swap never stalls the TTI loop. Connections, MCS, DRX timers and
+// average rates belong to the server and carry over unchanged.
+//
+// A connection is one UE, or a block of UEs after it sends a MUX hello (ue_mux.h); grants to
+// a multiplexed connection are batched into one PDU per TTI.
+//
+// Given a log path, every TTI's policy input and the grants sent are appended to a decision
+// log (decision_log.h) that `replay` can run policies against offline.
+//
+// --rt[=<cpu>] anywhere on the command line turns on the real-time profile (rt_profile.h) for
+// the TTI thread; how late it wakes up for each TTI is reported as JITTER with the stats.
+// The TTI thread then stops printing per TTI and per grant: stdout's lock is shared with the
+// client handlers and does not inherit priority.
+// --perf wraps each allocate_resources call in hardware counters (perf_counters.h), reported
+// per policy and awake-UE bucket as PERF lines with the stats.
+
+#define PORT 8080
+#define MAX_CLIENTS MUX_MAX_UES
+#define BUFFER_SIZE 1024
+#define TTI_DURATION 2000000
+#define MAX_UE_PER_TTI 4
+#define RB_PER_TTI 100
+#define MAX_TTI_DELAY 10
+#define MAX_MCS 27
+#define PF_AVERAGING_TTIS 100.0
+#define DEFAULT_POLICY "./policy_pf.so"
+
+typedef struct {
+    int socket;
+    struct sockaddr_in address;
+    int first_ue;           // client slot of the connection's first UE, -1 when it has none
+    int num_ues;
+    int multiplexed;
+    mux_pdu_t pdu;          // this TTI's grants while pdu_tti == current_tti
+    long pdu_tti;
+} connection_t;
+
+// One per UE, in the client slot of its id
+typedef struct {
+    connection_t *conn;
+    int mcs;
+    long last_grant_tti;
+    long rate_tti;          // TTI average_rate was last brought up to date
+    double average_rate;
+} client_t;
+
+client_t *clients[MAX_CLIENTS];
+pthread_mutex_t clients_mutex;     // priority inheritance (rt_init_mutex)
+long tti_duration_us = TTI_DURATION;
+long current_tti = 0;
+long long tti_start_ns = 0;
+tti_stats_t tti_stats;
+int connected_clients = 0;
+drx_t drx;
+
+// active_policy belongs to the TTI thread; the control thread offers a replacement through
+// pending_policy and gets the one it displaced back through retired_policy
+policy_t *active_policy = NULL;
+_Atomic(policy_t *) pending_policy = NULL;
+_Atomic(policy_t *) retired_policy = NULL;
+long policy_swaps = 0;
+decision_log_t decision_log;
+int logging = 0;
+rt_profile_t rt_profile;
+int trace_ttis = 1;         // per-TTI and per-grant lines on stdout, off with --rt
+tti_jitter_t tti_jitter;
+int perf_requested = 0;
+PerfCounters perf;
+
+sched_ue_t *candidates;     // MAX_CLIENTS, allocated by main (on huge pages with --rt)
+sched_grant_t grants[MAX_UE_PER_TTI];
+connection_t *pdu_connections[MAX_UE_PER_TTI];
+
+// Offers the policy to the TTI thread and waits for it to be taken, then unloads the one
+// it replaced
+void switch_policy(policy_t *policy) {
+    atomic_store(&pending_policy, policy);
+    while (atomic_load(&pending_policy) != NULL && !stop_requested) {
+        usleep(tti_duration_us < 1000 ? tti_duration_us : 1000);
+    }
+    policy_t *retired = atomic_exchange(&retired_policy, NULL);
+    if (retired != NULL) {
+        unload_policy(retired);
+    }
+}
+
+void *control_thread(void *arg) {
+    char line[512];
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char path[256];
+        if (sscanf(line, "load %255s", path) != 1) {
+            fprintf(stderr, "Unknown command: %s", line);
+            continue;
+        }
+        policy_t *policy = load_policy(path);
+        if (policy != NULL) {
+            switch_policy(policy);
+        }
+    }
+    return NULL;
+}
+
+// Gives the connection a block of count UEs in consecutive client slots (first fit);
+// returns 0 if there is no room. Callers hold clients_mutex.
+int add_clients(connection_t *conn, int count) {
+    int run = 0;
+    for (int i = 0; i < MAX_CLIENTS; ++i) {
+        run = clients[i] ? 0 : run + 1;
+        if (run < count) {
+            continue;
+        }
+        conn->first_ue = i - count + 1;
+        conn->num_ues = count;
+        for (int ue = conn->first_ue; ue <= i; ue++) {
+            client_t *cl = calloc(1, sizeof(client_t));
+            if (cl == NULL) {
+                perror("Failed to allocate UE");
+                exit(EXIT_FAILURE);
+            }
+            cl->conn = conn;
+            cl->mcs = rand() % (MAX_MCS + 1);
+            cl->last_grant_tti = -1;
+            cl->rate_tti = drx.wheel.now;
+            cl->average_rate = 1.0;
+            clients[ue] = cl;
+            drx_attach(&drx, ue);
+        }
+        connected_clients += count;
+        return 1;
+    }
+    return 0;
+}
+
+// Callers hold clients_mutex
+void remove_clients(connection_t *conn) {
+    for (int ue = conn->first_ue; ue >= 0 && ue < conn->first_ue + conn->num_ues; ue++) {
+        drx_detach(&drx, ue);
+        free(clients[ue]);
+        clients[ue] = NULL;
+    }
+    connected_clients -= conn->num_ues;
+    conn->first_ue = -1;
+    conn->num_ues = 0;
+}
+
+// "MUX <count>" swaps the connection's single UE for a block of count UEs
+void multiplex_connection(connection_t *conn, int count) {
+    char reply[BUFFER_SIZE];
+    pthread_mutex_lock(&clients_mutex);
+    remove_clients(conn);
+    if (count < 1 || count > MAX_CLIENTS || !add_clients(conn, count)) {
+        fprintf(stderr, "No room for %d UEs on connection %d\n", count, conn->socket);
+        count = 0;
+    }
+    conn->multiplexed = 1;
+    snprintf(reply, sizeof(reply), "MUX first=%d n=%d", conn->first_ue, count);
+    send(conn->socket, reply, strlen(reply) + 1, 0);
+    pthread_mutex_unlock(&clients_mutex);
+    printf("Connection %d multiplexes %d UEs from %d\n", conn->socket, count, conn->first_ue);
+}
+
+void *handle_client(void *arg) {
+    char buffer[BUFFER_SIZE];
+    int nbytes;
+    connection_t *conn = (connection_t *)arg;
+
+    printf("Client %d connected\n", conn->socket);
+
+    while ((nbytes = recv(conn->socket, buffer, sizeof(buffer) - 1, 0)) > 0) {
+        buffer[nbytes] = '\0';
+        int count;
+        if (!conn->multiplexed && sscanf(buffer, "MUX %d", &count) == 1) {
+            multiplex_connection(conn, count);
+            continue;
+        }
+        printf("Client %d: %s\n", conn->socket, buffer);
+    }
+
+    printf("Client %d disconnected\n", conn->socket);
+    pthread_mutex_lock(&clients_mutex);
+    remove_clients(conn);
+    pthread_mutex_unlock(&clients_mutex);
+    close(conn->socket);
+    free(conn);
+
+    return NULL;
+}
+
+void allocate_resources() {
+    pthread_mutex_lock(&clients_mutex);
+    drx_tick(&drx, current_tti);
+
+    if (drx.num_awake == 0) {
+        pthread_mutex_unlock(&clients_mutex);
+        return;
+    }
+
+    // The policy sees the awake UEs, with average rates decayed to this TTI
+    double decay = 1.0 - 1.0 / PF_AVERAGING_TTIS;
+    for (int a = 0; a < drx.num_awake; ++a) {
+        int i = drx.awake[a];
+        client_t *cl = clients[i];
+        if (cl->rate_tti != current_tti) {
+            cl->average_rate *= pow(decay, current_tti - cl->rate_tti);
+            cl->rate_tti = current_tti;
+        }
+        candidates[a] = (sched_ue_t){i, cl->mcs, drx.starved[i], 0, cl->last_grant_tti, cl->average_rate};
+    }
+    sched_input_t input = {current_tti, drx.num_awake, RB_PER_TTI, MAX_UE_PER_TTI, 0, candidates};
+    int count = active_policy->api->schedule(active_policy->state, &input, grants);
+
+    // A plugin is outside code: drop a TTI's grants rather than trust an invalid set
+    int valid = count >= 0 && count <= MAX_UE_PER_TTI;
+    int total_rbs = 0;
+    for (int g = 0; valid && g < count; g++) {
+        valid = grants[g].ue >= 0 && grants[g].ue < drx.num_awake && grants[g].resource_blocks >= 0;
+        total_rbs += grants[g].resource_blocks;
+    }
+    if (!valid || total_rbs > RB_PER_TTI) {
+        fprintf(stderr, "Policy %s returned invalid grants at TTI %ld\n", active_policy->api->name, current_tti);
+        count = 0;
+    }
+    count = decision_log_sent_grants(grants, count);
+    if (logging) {
+        decision_log_tti(&decision_log, current_tti, tti_start_ns, candidates, drx.num_awake, grants, count);
+    }
+
+    // Plain UEs get their grant right away; a multiplexed connection gets one PDU after the loop
+    int num_pdus = 0;
+    for (int g = 0; g < count; g++) {
+        int i = candidates[grants[g].ue].id;
+        int rbs = grants[g].resource_blocks;
+        client_t *cl = clients[i];
+        connection_t *conn = cl->conn;
+        if (trace_ttis) {
+            printf("Allocating %d RBs to UE %d with MCS %d (%s)\n", rbs, i, cl->mcs, active_policy->api->name);
+        }
+        if (conn->multiplexed) {
+            if (conn->pdu_tti != current_tti) {
+                conn->pdu_tti = current_tti;
+                mux_pdu_begin(&conn->pdu, current_tti, tti_start_ns);
+                pdu_connections[num_pdus++] = conn;
+            }
+            if (!mux_pdu_add(&conn->pdu, i, rbs)) {
+                send(conn->socket, conn->pdu.text, mux_pdu_bytes(&conn->pdu), 0);
+                tti_stats.sends++;
+                mux_pdu_begin(&conn->pdu, current_tti, tti_start_ns);
+                mux_pdu_add(&conn->pdu, i, rbs);
+            }
+        } else {
+            char message[BUFFER_SIZE];
+            snprintf(message, sizeof(message), "Allocated %d RBs tti=%ld t=%lld", rbs, current_tti, tti_start_ns);
+            send(conn->socket, message, strlen(message) + 1, 0);
+            tti_stats.sends++;
+        }
+        drx_granted(&drx, i);
+        cl->last_grant_tti = current_tti;
+        cl->average_rate += rbs * (cl->mcs + 1) / PF_AVERAGING_TTIS;
+        tti_stats.grants++;
+    }
+    for (int p = 0; p < num_pdus; p++) {
+        connection_t *conn = pdu_connections[p];
+        send(conn->socket, conn->pdu.text, mux_pdu_bytes(&conn->pdu), 0);
+        tti_stats.sends++;
+    }
+
+    pthread_mutex_unlock(&clients_mutex);
+}
+
+void *tti_scheduler(void *arg) {
+    struct timespec deadline;
+    if (rt_profile.enabled) {
+        rt_setup_thread(&rt_profile);
+    }
+    if (perf_requested && !perf_counters_open(&perf)) {
+        fprintf(stderr, "No hardware counters available\n");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while (!stop_requested) {
+        tti_advance(&deadline, tti_duration_us);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        tti_start_ns = tti_now_ns();
+        tti_jitter_add(&tti_jitter, &deadline, tti_start_ns);
+        // The displaced policy is handed back before pending_policy is cleared, since clearing it
+        // is what tells the control thread to collect it
+        policy_t *next = atomic_load(&pending_policy);
+        if (next != NULL) {
+            atomic_store(&retired_policy, active_policy);
+            atomic_store(&pending_policy, NULL);
+            active_policy = next;
+            policy_swaps++;
+            if (trace_ttis) {
+                printf("Switched to policy %s at TTI %ld\n", next->api->name, current_tti);
+            }
+            fprintf(stderr, "POLICY %s tti=%ld swaps=%ld\n", next->api->name, current_tti, policy_swaps);
+            if (logging) {
+                decision_log_policy(&decision_log, current_tti, next->api->name);
+            }
+        }
+
+        if (trace_ttis) {
+            printf("Starting new TTI ...\n");
+        }
+        perf_begin(&perf);
+        allocate_resources();
+        perf_end(&perf, active_policy->api->name, drx.num_awake);
+        current_tti++;
+        tti_stats.ttis++;
+        if (tti_overran(&deadline, tti_duration_us)) {
+            tti_stats.overruns++;
+        }
+        if (stats_requested) {
+            stats_requested = 0;
+            tti_print_stats(&tti_stats, connected_clients);
+            tti_print_jitter(&tti_jitter);
+            perf_report(&perf, stderr);
+        }
+    }
+
+    tti_print_stats(&tti_stats, connected_clients);
+    tti_print_jitter(&tti_jitter);
+    perf_report(&perf, stderr);
+    if (logging) {
+        decision_log_close(&decision_log);
+        fprintf(stderr, "Logged %lld records (%ld window switches waited for the mapper)\n", decision_log.records,
+                decision_log.late_windows);
+    }
+    fflush(stdout);
+    exit(0);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int server_socket, new_socket;
+    struct sockaddr_in server_addr, client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    pthread_t tid, tti_tid, control_tid;
+    int port = PORT;
+    int reuse = 1;
+
+    // --rt[=<cpu>] and --perf are taken out first so the positional arguments keep their places
+    int positional = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--perf") == 0) {
+            perf_requested = 1;
+        } else if (!rt_parse(&rt_profile, argv[i])) {
+            argv[positional++] = argv[i];
+        }
+    }
+    argc = positional;
+    rt_init_mutex(&clients_mutex);
+    if (rt_profile.enabled) {
+        rt_lock_memory(&rt_profile);
+        trace_ttis = 0;
+    }
+    candidates = rt_alloc(&rt_profile, MAX_CLIENTS * sizeof(sched_ue_t), "candidate table");
+
+    // Optional: TTI length in microseconds, port, DRX cycle in TTIs (0 = off), the initial
+    // policy plugin and a decision log to write
+    if (argc > 1) {
+        tti_duration_us = atol(argv[1]);
+    }
+    if (argc > 2) {
+        port = atoi(argv[2]);
+    }
+    drx_init(&drx, MAX_CLIENTS, argc > 3 ? atoi(argv[3]) : 0, MAX_TTI_DELAY);
+    active_policy = load_policy(argc > 4 ? argv[4] : DEFAULT_POLICY);
+    if (active_policy == NULL) {
+        exit(EXIT_FAILURE);
+    }
+    if (argc > 5) {
+        decision_log_open(&decision_log, argv[5], tti_duration_us, RB_PER_TTI, MAX_UE_PER_TTI);
+        decision_log_policy(&decision_log, 0, active_policy->api->name);
+        logging = 1;
+    }
+    signal(SIGINT, tti_request_stop);
+    signal(SIGTERM, tti_request_stop);
+    signal(SIGUSR1, tti_request_stats);
+
+    server_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_socket == -1) {
+        perror("Socket creation failed");
+        exit(EXIT_FAILURE);
+    }
+    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+    server_addr.sin_port = htons(port);
+
+    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        perror("Socket bind failed");
+        close(server_socket);
+        exit(EXIT_FAILURE);
+    }
+
+    if (listen(server_socket, SOMAXCONN) == -1) {
+        perror("Socket listen failed");
+        close(server_socket);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Server listening on port %d with policy %s\n", port, active_policy->api->name);
+
+    if (rt_profile.enabled) {
+        rt_reserve_cpu(&rt_profile);
+    }
+    if (logging) {
+        decision_log_start_mapper(&decision_log);
+    }
+
+    pthread_create(&tti_tid, NULL, tti_scheduler, NULL);
+    pthread_detach(tti_tid);
+    pthread_create(&control_tid, NULL, control_thread, NULL);
+    pthread_detach(control_tid);
+
+    while (1) {
+        new_socket = accept(server_socket, (struct sockaddr *)&client_addr, &client_len);
+        if (new_socket == -1) {
+            perror("Socket accept failed");
+            continue;
+        }
+
+        connection_t *conn = (connection_t *)calloc(1, sizeof(connection_t));
+        conn->socket = new_socket;
+        conn->address = client_addr;
+        conn->first_ue = -1;
+        conn->pdu_tti = -1;
+
+        pthread_mutex_lock(&clients_mutex);
+        int added = add_clients(conn, 1);
+        pthread_mutex_unlock(&clients_mutex);
+        if (!added) {
+            fprintf(stderr, "No room for another UE\n");
+            close(new_socket);
+            free(conn);
+            continue;
+        }
+        pthread_create(&tid, NULL, handle_client, (void *)conn);
+        pthread_detach(tid);
+    }
+
+    close(server_socket);
+    return 0;
+}
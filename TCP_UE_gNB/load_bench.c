@@ -0,0 +1,303 @@
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "tti_clock.h"
+#include "ue_mux.h"
+
+// End-to-end load benchmark for server_rr, server_max and server_pf.
+// Starts the server headless on localhost with a short TTI, connects num_ues UE sockets and
+// lets it warm up, snapshots its counters with SIGUSR1, collects every grant for duration_s
+// seconds, then stops the server with SIGTERM and diffs the final STATS line against the
+// snapshot. Grant latency is receive time minus the TTI start stamped into the grant (both
+// CLOCK_MONOTONIC on the same host). With ues_per_conn > 1 (gnb_server only) the UEs share
+// connections, ues_per_conn each, and receive aggregated grant PDUs (ue_mux.h).
+// The servers silently leave UEs beyond their capacity unserved (12 for server_rr and
+// server_max, 100 for server_pf), so the run is rejected unless the snapshot shows all
+// num_ues connected.
+// Output is one CSV row:
+//   server,ues,tti_us,duration_s,ttis_per_s,overrun_rate,grant_p50_us,grant_p99_us,grant_p999_us,sends_per_tti,jain_fairness
+//
+// Usage: load_bench <server_binary> [num_ues] [duration_s] [tti_us] [port] [drx_cycle] [ues_per_conn]
+
+#define BUFFER_SIZE 1024
+#define MAX_UES MUX_MAX_UES
+#define CONNECT_RETRIES 100
+#define INITIAL_SAMPLES 65536
+#define WARMUP_NS 200000000LL
+
+typedef struct {
+    int socket;
+    char pending[BUFFER_SIZE];
+    int pending_len;
+    int first_ue;       // server id of the connection's first UE, -1 until a MUX reply
+    int num_ues;
+    int index;          // of its first UE in the benchmark's UE arrays
+} connection_t;
+
+long long *resource_blocks;     // per UE
+
+double *latency_us;
+long num_samples = 0;
+long sample_capacity = 0;
+
+void add_sample(double value) {
+    if (num_samples == sample_capacity) {
+        sample_capacity = sample_capacity ? sample_capacity * 2 : INITIAL_SAMPLES;
+        latency_us = realloc(latency_us, sample_capacity * sizeof(double));
+        if (latency_us == NULL) {
+            perror("Failed to grow latency samples");
+            exit(EXIT_FAILURE);
+        }
+    }
+    latency_us[num_samples++] = value;
+}
+
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+double percentile(double fraction) {
+    if (num_samples == 0) {
+        return 0;
+    }
+    long index = (long)(fraction * (num_samples - 1) + 0.5);
+    return latency_us[index];
+}
+
+int connect_ue(int port) {
+    struct sockaddr_in server;
+    server.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server.sin_family = AF_INET;
+    server.sin_port = htons(port);
+
+    // The server may still be starting up
+    for (int attempt = 0; attempt < CONNECT_RETRIES; attempt++) {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock == -1) {
+            perror("Could not create socket");
+            exit(EXIT_FAILURE);
+        }
+        if (connect(sock, (struct sockaddr *)&server, sizeof(server)) == 0) {
+            return sock;
+        }
+        close(sock);
+        usleep(10000);
+    }
+    perror("Connect failed");
+    exit(EXIT_FAILURE);
+}
+
+// Grants are NUL-terminated strings and may arrive split or coalesced
+void receive_grants(connection_t *conn) {
+    int space = BUFFER_SIZE - conn->pending_len;
+    int nbytes = recv(conn->socket, conn->pending + conn->pending_len, space, 0);
+    long long now = tti_now_ns();
+    if (nbytes <= 0) {
+        return;
+    }
+    conn->pending_len += nbytes;
+
+    int start = 0;
+    for (int i = 0; i < conn->pending_len; i++) {
+        if (conn->pending[i] != '\0') {
+            continue;
+        }
+        const char *message = conn->pending + start;
+        start = i + 1;
+        int rbs[MUX_PDU_SIZE / 4], ues[MUX_PDU_SIZE / 4], count;
+        long tti;
+        long long tti_start;
+        if (sscanf(message, "Allocated %d RBs tti=%ld t=%lld", &rbs[0], &tti, &tti_start) == 3) {
+            resource_blocks[conn->index] += rbs[0];
+            add_sample((now - tti_start) / 1000.0);
+        } else if (sscanf(message, "MUX first=%d n=%d", &conn->first_ue, &count) == 2) {
+            if (count != conn->num_ues) {
+                fprintf(stderr, "Server gave %d of %d UEs to a connection\n", count, conn->num_ues);
+            }
+        } else if ((count = mux_parse_grants(message, &tti, &tti_start, ues, rbs, MUX_PDU_SIZE / 4)) >= 0) {
+            for (int g = 0; g < count; g++) {
+                int local = ues[g] - conn->first_ue;
+                if (conn->first_ue >= 0 && local >= 0 && local < conn->num_ues) {
+                    resource_blocks[conn->index + local] += rbs[g];
+                    add_sample((now - tti_start) / 1000.0);
+                }
+            }
+        }
+    }
+    memmove(conn->pending, conn->pending + start, conn->pending_len - start);
+    conn->pending_len -= start;
+    if (conn->pending_len == BUFFER_SIZE) {
+        conn->pending_len = 0;  // not a grant stream; drop it
+    }
+}
+
+// Receives grants on every connection until the deadline
+void collect_grants(connection_t *connections, struct pollfd *fds, int num_connections, long long end) {
+    long long now;
+    while ((now = tti_now_ns()) < end) {
+        int timeout_ms = (int)((end - now) / 1000000) + 1;
+        int ready = poll(fds, num_connections, timeout_ms);
+        if (ready < 0 && errno != EINTR) {
+            perror("poll");
+            return;
+        }
+        for (int i = 0; i < num_connections && ready > 0; i++) {
+            if (fds[i].revents & POLLIN) {
+                receive_grants(&connections[i]);
+                ready--;
+            }
+        }
+    }
+}
+
+// Reads STATS lines from the server until one arrives; returns 0 on EOF
+int read_stats(FILE *server_stderr, tti_stats_t *stats, int *ues) {
+    char line[256];
+    while (fgets(line, sizeof(line), server_stderr) != NULL) {
+        if (sscanf(line, "STATS ttis=%ld overruns=%ld grants=%ld sends=%ld ues=%d", &stats->ttis, &stats->overruns,
+                   &stats->grants, &stats->sends, ues) == 5) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+double jain_fairness(int num_ues) {
+    double sum = 0, sum_squares = 0;
+    for (int i = 0; i < num_ues; i++) {
+        sum += resource_blocks[i];
+        sum_squares += (double)resource_blocks[i] * resource_blocks[i];
+    }
+    return sum_squares > 0 ? sum * sum / (num_ues * sum_squares) : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <server_binary> [num_ues] [duration_s] [tti_us] [port] [drx_cycle] [ues_per_conn]\n",
+                argv[0]);
+        return 1;
+    }
+    const char *server = argv[1];
+    int num_ues = argc > 2 ? atoi(argv[2]) : 12;
+    double duration_s = argc > 3 ? atof(argv[3]) : 5.0;
+    const char *tti_us = argc > 4 ? argv[4] : "1000";
+    const char *port_arg = argc > 5 ? argv[5] : "8080";
+    const char *drx_cycle = argc > 6 ? argv[6] : NULL;
+    int ues_per_conn = argc > 7 ? atoi(argv[7]) : 1;
+    int port = atoi(port_arg);
+
+    if (num_ues < 1 || num_ues > MAX_UES || duration_s <= 0 || atol(tti_us) <= 0 || ues_per_conn < 1) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    // Server stdout goes to /dev/null; its stderr carries the STATS line back to us
+    int stats_pipe[2];
+    if (pipe(stats_pipe) == -1) {
+        perror("pipe");
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        return 1;
+    }
+    if (pid == 0) {
+        freopen("/dev/null", "w", stdout);
+        dup2(stats_pipe[1], STDERR_FILENO);
+        close(stats_pipe[0]);
+        close(stats_pipe[1]);
+        execl(server, server, tti_us, port_arg, drx_cycle, (char *)NULL);
+        perror("exec");
+        _exit(127);
+    }
+    close(stats_pipe[1]);
+
+    int num_connections = (num_ues + ues_per_conn - 1) / ues_per_conn;
+    connection_t *connections = calloc(num_connections, sizeof(connection_t));
+    struct pollfd *fds = calloc(num_connections, sizeof(struct pollfd));
+    resource_blocks = calloc(num_ues, sizeof(long long));
+    for (int i = 0; i < num_connections; i++) {
+        connection_t *conn = &connections[i];
+        conn->socket = connect_ue(port);
+        conn->index = i * ues_per_conn;
+        conn->num_ues = num_ues - conn->index < ues_per_conn ? num_ues - conn->index : ues_per_conn;
+        conn->first_ue = -1;
+        if (ues_per_conn > 1) {
+            char hello[32];
+            snprintf(hello, sizeof(hello), "MUX %d", conn->num_ues);
+            send(conn->socket, hello, strlen(hello) + 1, 0);
+        }
+        fds[i].fd = conn->socket;
+        fds[i].events = POLLIN;
+    }
+
+    FILE *server_stderr = fdopen(stats_pipe[0], "r");
+    tti_stats_t before = {0}, stats = {0};
+    int admitted = 0;
+
+    // Warm up, then take the counters and drop everything collected so far
+    collect_grants(connections, fds, num_connections, tti_now_ns() + WARMUP_NS);
+    kill(pid, SIGUSR1);
+    if (!read_stats(server_stderr, &before, &admitted)) {
+        fprintf(stderr, "%s exited before the measurement started\n", server);
+        return 1;
+    }
+    if (admitted < num_ues) {
+        fprintf(stderr, "%s admitted only %d of %d UEs; lower num_ues to its capacity\n", server, admitted, num_ues);
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+        return 1;
+    }
+    num_samples = 0;
+    memset(resource_blocks, 0, num_ues * sizeof(long long));
+
+    long long start = tti_now_ns();
+    collect_grants(connections, fds, num_connections, start + (long long)(duration_s * 1e9));
+    kill(pid, SIGTERM);
+    double elapsed_s = (tti_now_ns() - start) / 1e9;
+    read_stats(server_stderr, &stats, &admitted);
+    fclose(server_stderr);
+    waitpid(pid, NULL, 0);
+
+    stats.ttis -= before.ttis;
+    stats.overruns -= before.overruns;
+    stats.grants -= before.grants;
+    stats.sends -= before.sends;
+
+    for (int i = 0; i < num_connections; i++) {
+        close(connections[i].socket);
+    }
+
+    if (stats.ttis == 0) {
+        fprintf(stderr, "%s reported no TTIs\n", server);
+        return 1;
+    }
+
+    qsort(latency_us, num_samples, sizeof(double), compare_doubles);
+    const char *name = strrchr(server, '/') ? strrchr(server, '/') + 1 : server;
+    printf("server,ues,tti_us,duration_s,ttis_per_s,overrun_rate,grant_p50_us,grant_p99_us,grant_p999_us,sends_per_tti,jain_fairness\n");
+    printf("%s,%d,%s,%.2f,%.1f,%.5f,%.1f,%.1f,%.1f,%.2f,%.4f\n", name, num_ues, tti_us, elapsed_s,
+           stats.ttis / elapsed_s, (double)stats.overruns / stats.ttis,
+           percentile(0.5), percentile(0.99), percentile(0.999),
+           (double)stats.sends / stats.ttis, jain_fairness(num_ues));
+    if (num_samples != stats.grants) {
+        fprintf(stderr, "# %ld grants sent, %ld received before shutdown\n", stats.grants, num_samples);
+    }
+
+    free(latency_us);
+    free(connections);
+    free(resource_blocks);
+    free(fds);
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef POLICY_LOADER_H
+#define POLICY_LOADER_H
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sched_plugin.h"
+
+// Loading and unloading scheduler plugins (sched_plugin.h), shared by gnb_server and replay.
+// Each loaded policy gets its own zeroed private state.
+
+typedef struct {
+    void *handle;
+    const sched_plugin_t *api;
+    void *state;
+    char path[256];
+} policy_t;
+
+static inline policy_t *load_policy(const char *path) {
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        fprintf(stderr, "Failed to load policy: %s\n", dlerror());
+        return NULL;
+    }
+    sched_plugin_entry_fn entry = (sched_plugin_entry_fn)dlsym(handle, SCHED_PLUGIN_ENTRY);
+    const sched_plugin_t *api = entry ? entry() : NULL;
+    if (api == NULL || api->abi_version != SCHED_PLUGIN_ABI_VERSION || api->struct_size < sizeof(sched_plugin_t) ||
+        api->schedule == NULL) {
+        fprintf(stderr, "%s is not a version %d scheduler plugin\n", path, SCHED_PLUGIN_ABI_VERSION);
+        dlclose(handle);
+        return NULL;
+    }
+
+    policy_t *policy = calloc(1, sizeof(policy_t));
+    void *state = calloc(1, api->state_size > 0 ? api->state_size : 1);
+    if (policy == NULL || state == NULL) {
+        perror("Failed to allocate policy");
+        exit(EXIT_FAILURE);
+    }
+    policy->handle = handle;
+    policy->state = state;
+    policy->api = api;
+    snprintf(policy->path, sizeof(policy->path), "%s", path);
+    return policy;
+}
+
+static inline void unload_policy(policy_t *policy) {
+    dlclose(policy->handle);
+    free(policy->state);
+    free(policy);
+}
+
+#endif
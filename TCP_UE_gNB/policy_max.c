@@ -0,0 +1,28 @@
+#include "sched_plugin.h"
+
+// Max C/I: every RB to the UE with the highest MCS (ties to the lowest client slot).
+
+static int max_schedule(void *state, const sched_input_t *input, sched_grant_t *grants) {
+    (void)state;
+    int best = -1;
+    for (int i = 0; i < input->num_ues; i++) {
+        const sched_ue_t *ue = &input->ues[i];
+        if (best < 0 || ue->mcs > input->ues[best].mcs || (ue->mcs == input->ues[best].mcs && ue->id < input->ues[best].id)) {
+            best = i;
+        }
+    }
+    if (best < 0 || input->max_grants < 1) {
+        return 0;
+    }
+    grants[0].ue = best;
+    grants[0].resource_blocks = input->resource_blocks;
+    return 1;
+}
+
+static const sched_plugin_t plugin = {
+    SCHED_PLUGIN_ABI_VERSION, sizeof(sched_plugin_t), "max", 0, max_schedule,
+};
+
+const sched_plugin_t *sched_plugin_entry(void) {
+    return &plugin;
+}
@@ -0,0 +1,40 @@
+#include "sched_plugin.h"
+
+// Proportional fair: every RB to the UE with the best (MCS + 1) / average rate, where UEs
+// starved past the SR timeout come first, as in server_pf (ties to the lowest client slot).
+
+static int pf_schedule(void *state, const sched_input_t *input, sched_grant_t *grants) {
+    (void)state;
+    int best = -1;
+    double best_metric = 0;
+    for (int i = 0; i < input->num_ues; i++) {
+        const sched_ue_t *ue = &input->ues[i];
+        double metric = (ue->mcs + 1) / ue->average_rate;
+        if (best >= 0) {
+            const sched_ue_t *current = &input->ues[best];
+            if (ue->starved != current->starved) {
+                if (ue->starved < current->starved) {
+                    continue;
+                }
+            } else if (metric < best_metric || (metric == best_metric && ue->id > current->id)) {
+                continue;
+            }
+        }
+        best = i;
+        best_metric = metric;
+    }
+    if (best < 0 || input->max_grants < 1) {
+        return 0;
+    }
+    grants[0].ue = best;
+    grants[0].resource_blocks = input->resource_blocks;
+    return 1;
+}
+
+static const sched_plugin_t plugin = {
+    SCHED_PLUGIN_ABI_VERSION, sizeof(sched_plugin_t), "pf", 0, pf_schedule,
+};
+
+const sched_plugin_t *sched_plugin_entry(void) {
+    return &plugin;
+}
@@ -0,0 +1,49 @@
+#include "sched_plugin.h"
+
+// Round robin: up to max_grants UEs per TTI in client slot order, starting after the last UE
+// served, with the RBs split evenly between them.
+
+typedef struct {
+    int32_t cursor;     // first client slot to serve next
+} rr_state_t;
+
+static int rr_schedule(void *state, const sched_input_t *input, sched_grant_t *grants) {
+    rr_state_t *rr = state;
+    int count = input->max_grants < input->num_ues ? input->max_grants : input->num_ues;
+    if (count <= 0) {
+        return 0;
+    }
+
+    // The count UEs closest after the cursor, in cyclic slot order
+    long keys[count];
+    int found = 0;
+    for (int i = 0; i < input->num_ues; i++) {
+        int id = input->ues[i].id;
+        long key = id >= rr->cursor ? id - rr->cursor : id + (1L << 31);
+        if (found == count && key >= keys[count - 1]) {
+            continue;
+        }
+        int pos = found < count ? found++ : count - 1;
+        while (pos > 0 && keys[pos - 1] > key) {
+            keys[pos] = keys[pos - 1];
+            grants[pos] = grants[pos - 1];
+            pos--;
+        }
+        keys[pos] = key;
+        grants[pos].ue = i;
+    }
+
+    for (int g = 0; g < found; g++) {
+        grants[g].resource_blocks = input->resource_blocks / found;
+    }
+    rr->cursor = input->ues[grants[found - 1].ue].id + 1;
+    return found;
+}
+
+static const sched_plugin_t plugin = {
+    SCHED_PLUGIN_ABI_VERSION, sizeof(sched_plugin_t), "rr", sizeof(rr_state_t), rr_schedule,
+};
+
+const sched_plugin_t *sched_plugin_entry(void) {
+    return &plugin;
+}
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "decision_log.h"
+#include "policy_loader.h"
+#include "ue_mux.h"
+
+// Offline replay of a gnb_server decision log.
+// Summarizes the recorded decisions, then runs each given policy plugin over the recorded
+// per-TTI inputs as fast as it can, reporting how often it made the recorded decision, the
+// RBs and rate it would have handed out, Jain's fairness over UEs and the time per decision.
+// Inputs are replayed as captured, so a policy other than the recorded one is judged on the
+// load the recorded policy produced (its grants do not feed back into the UE averages).
+//
+// Usage: replay <decision_log> [policy.so ...]
+
+typedef struct {
+    long long ttis;
+    long long ue_ttis;
+    long long grants;
+    long long matches;
+    long long resource_blocks;
+    double rate;                // sum of RBs * (MCS + 1), the servers' rate unit
+    double ns;
+    long long *ue_rbs;          // per UE id
+} replay_stats_t;
+
+double now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+double jain_fairness(const long long *ue_rbs, const unsigned char *seen) {
+    double sum = 0, sum_squares = 0;
+    int count = 0;
+    for (int id = 0; id < MUX_MAX_UES; id++) {
+        if (seen[id]) {
+            sum += ue_rbs[id];
+            sum_squares += (double)ue_rbs[id] * ue_rbs[id];
+            count++;
+        }
+    }
+    return sum_squares > 0 ? sum * sum / (count * sum_squares) : 0;
+}
+
+void account(replay_stats_t *stats, const sched_ue_t *ues, int num_ues, const sched_grant_t *grants, int count) {
+    for (int g = 0; g < count; g++) {
+        if (grants[g].ue < 0 || grants[g].ue >= num_ues) {
+            continue;
+        }
+        const sched_ue_t *ue = &ues[grants[g].ue];
+        stats->grants++;
+        stats->resource_blocks += grants[g].resource_blocks;
+        stats->rate += (double)grants[g].resource_blocks * (ue->mcs + 1);
+        stats->ue_rbs[ue->id] += grants[g].resource_blocks;
+    }
+}
+
+// Same decision: the same UEs with the same RBs, in any order (a is known to be valid)
+int same_grants(const sched_grant_t *a, int count_a, const sched_grant_t *b, int count_b) {
+    if (count_a != count_b) {
+        return 0;
+    }
+    for (int i = 0; i < count_a; i++) {
+        int found = 0;
+        for (int j = 0; j < count_b && !found; j++) {
+            found = a[i].ue == b[j].ue && a[i].resource_blocks == b[j].resource_blocks;
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Match rate and time per decision only mean something for a replayed policy
+void print_stats(const char *name, const replay_stats_t *stats, const unsigned char *seen, int replayed) {
+    char matches[32] = "-", ns[32] = "-";
+    if (replayed && stats->ttis > 0) {
+        snprintf(matches, sizeof(matches), "%.2f%%", 100.0 * stats->matches / stats->ttis);
+        snprintf(ns, sizeof(ns), "%.1f", stats->ns / stats->ttis);
+    }
+    printf("%-20s %10lld %10lld %12lld %14.0f %10.4f %10s %10s\n", name, stats->ttis, stats->grants, stats->resource_blocks,
+           stats->rate, jain_fairness(stats->ue_rbs, seen), matches, ns);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <decision_log> [policy.so ...]\n", argv[0]);
+        return 1;
+    }
+
+    decision_log_reader_t reader;
+    decision_log_read_open(&reader, argv[1]);
+    int max_grants = reader.header.max_grants;
+    sched_grant_t *grants = malloc((max_grants > 0 ? max_grants : 1) * sizeof(sched_grant_t));
+    unsigned char *seen = calloc(MUX_MAX_UES, 1);
+    replay_stats_t recorded = {0};
+    recorded.ue_rbs = calloc(MUX_MAX_UES, sizeof(long long));
+
+    // The recorded run
+    const decision_log_record_t *record;
+    long long first_tti = -1, last_tti = -1;
+    while ((record = decision_log_next(&reader)) != NULL) {
+        if (record->type == DECISION_LOG_POLICY) {
+            printf("TTI %lld: policy %.*s\n", (long long)record->tti, DECISION_LOG_POLICY_NAME, (const char *)(record + 1));
+            continue;
+        }
+        if (record->type != DECISION_LOG_TTI) {
+            continue;
+        }
+        const sched_ue_t *ues = decision_log_ues(record);
+        for (int i = 0; i < record->num_ues; i++) {
+            if (ues[i].id < 0 || ues[i].id >= MUX_MAX_UES) {
+                fprintf(stderr, "UE id %d out of range at TTI %lld\n", ues[i].id, (long long)record->tti);
+                return 1;
+            }
+            seen[ues[i].id] = 1;
+        }
+        first_tti = first_tti < 0 ? record->tti : first_tti;
+        last_tti = record->tti;
+        recorded.ttis++;
+        recorded.ue_ttis += record->num_ues;
+        account(&recorded, ues, record->num_ues, decision_log_grants(record), record->num_grants);
+    }
+
+    printf("\n%s: %lld TTIs with awake UEs (TTI %lld to %lld, %ld us each), %.1f awake UEs on average, %d RBs and up to %d "
+           "grants per TTI\n\n",
+           argv[1], recorded.ttis, first_tti, last_tti, (long)reader.header.tti_us,
+           recorded.ttis > 0 ? (double)recorded.ue_ttis / recorded.ttis : 0, reader.header.resource_blocks, max_grants);
+    printf("%-20s %10s %10s %12s %14s %10s %10s %10s\n", "policy", "ttis", "grants", "rbs", "rate", "jain", "match",
+           "ns/tti");
+    print_stats("recorded", &recorded, seen, 0);
+
+    for (int p = 2; p < argc; p++) {
+        policy_t *policy = load_policy(argv[p]);
+        if (policy == NULL) {
+            continue;
+        }
+        replay_stats_t stats = {0};
+        stats.ue_rbs = calloc(MUX_MAX_UES, sizeof(long long));
+
+        decision_log_rewind(&reader);
+        while ((record = decision_log_next(&reader)) != NULL) {
+            if (record->type != DECISION_LOG_TTI) {
+                continue;
+            }
+            const sched_ue_t *ues = decision_log_ues(record);
+            sched_input_t input = {record->tti, record->num_ues, reader.header.resource_blocks, max_grants, 0, ues};
+
+            double start = now_ns();
+            int count = policy->api->schedule(policy->state, &input, grants);
+            stats.ns += now_ns() - start;
+
+            int valid = count >= 0 && count <= max_grants;
+            int total_rbs = 0;
+            for (int g = 0; valid && g < count; g++) {
+                valid = grants[g].ue >= 0 && grants[g].ue < record->num_ues && grants[g].resource_blocks >= 0;
+                total_rbs += grants[g].resource_blocks;
+            }
+            if (!valid || total_rbs > reader.header.resource_blocks) {
+                count = 0;
+            }
+            // As the server does: 0-RB grants are not sent, so they are not compared
+            count = decision_log_sent_grants(grants, count);
+
+            stats.ttis++;
+            account(&stats, ues, record->num_ues, grants, count);
+            stats.matches += same_grants(grants, count, decision_log_grants(record), record->num_grants);
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s", policy->api->name);
+        print_stats(name, &stats, seen, 1);
+        free(stats.ue_rbs);
+        unload_policy(policy);
+    }
+
+    free(grants);
+    free(seen);
+    free(recorded.ue_rbs);
+    decision_log_read_close(&reader);
+    return 0;
+}
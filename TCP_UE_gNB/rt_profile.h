@@ -0,0 +1,179 @@
+#ifndef RT_PROFILE_H
+#define RT_PROFILE_H
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Real-time deployment profile for a TTI thread:
+//   - the TTI thread runs alone on one CPU (ideally listed in isolcpus), other threads avoid it
+//   - the TTI thread runs SCHED_FIFO
+//   - all memory is locked (mlockall) and the hot tables are allocated up front, on huge
+//     pages when the system has them, and touched so no page fault lands in a TTI
+// Every step reports what it did or why it failed; the server keeps running either way and
+// prints how many steps failed, since a non-real-time run is still useful for testing.
+//
+// Needs _GNU_SOURCE, defined before the first system header, for the affinity calls.
+
+#define RT_DEFAULT_PRIORITY 80
+#define RT_STACK_PREFAULT (256 * 1024)
+#define RT_HUGE_PAGE (2UL << 20)
+
+typedef struct {
+    int enabled;
+    int cpu;
+    int priority;
+    int failures;
+} rt_profile_t;
+
+static inline void rt_report(rt_profile_t *rt, int ok, const char *step, int error) {
+    if (ok) {
+        fprintf(stderr, "RT %s: ok\n", step);
+    } else {
+        fprintf(stderr, "RT %s: FAILED (%s)\n", step, strerror(error));
+        rt->failures++;
+    }
+}
+
+// Parses "--rt" or "--rt=<cpu>"; the default CPU is the last one
+static inline int rt_parse(rt_profile_t *rt, const char *arg) {
+    if (strncmp(arg, "--rt", 4) != 0 || (arg[4] != '\0' && arg[4] != '=')) {
+        return 0;
+    }
+    rt->enabled = 1;
+    rt->cpu = arg[4] == '=' ? atoi(arg + 5) : (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    rt->priority = RT_DEFAULT_PRIORITY;
+    return 1;
+}
+
+// 1 if cpu is in /sys/devices/system/cpu/isolated (a list like "2-3,6")
+static inline int rt_cpu_isolated(int cpu) {
+    char list[256] = "";
+    FILE *file = fopen("/sys/devices/system/cpu/isolated", "r");
+    if (file == NULL) {
+        return 0;
+    }
+    if (fgets(list, sizeof(list), file) == NULL) {
+        list[0] = '\0';
+    }
+    fclose(file);
+    for (char *range = strtok(list, ",\n"); range != NULL; range = strtok(NULL, ",\n")) {
+        int first, last;
+        int fields = sscanf(range, "%d-%d", &first, &last);
+        if (fields == 1) {
+            last = first;
+        }
+        if (fields >= 1 && cpu >= first && cpu <= last) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Zeroed memory for a hot table: explicit huge pages if any are reserved, else transparent
+// huge pages if enabled, else normal pages; touched before it is returned
+static inline void *rt_alloc(rt_profile_t *rt, size_t bytes, const char *name) {
+    if (!rt->enabled) {
+        void *memory = calloc(1, bytes);
+        if (memory == NULL) {
+            perror("Failed to allocate hot table");
+            exit(EXIT_FAILURE);
+        }
+        return memory;
+    }
+    size_t length = (bytes + RT_HUGE_PAGE - 1) & ~(RT_HUGE_PAGE - 1);
+    const char *kind = "huge pages";
+    void *memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory == MAP_FAILED) {
+        memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            perror("Failed to allocate hot table");
+            exit(EXIT_FAILURE);
+        }
+        kind = madvise(memory, length, MADV_HUGEPAGE) == 0 ? "transparent huge pages" : "normal pages";
+    }
+    memset(memory, 0, length);
+    fprintf(stderr, "RT %s: %zu KB on %s\n", name, length >> 10, kind);
+    return memory;
+}
+
+// Priority inheritance: while the SCHED_FIFO TTI thread waits for the mutex, whichever
+// thread holds it runs at the TTI thread's priority, so lower priority work cannot hold it up
+static inline void rt_init_mutex(pthread_mutex_t *mutex) {
+    pthread_mutexattr_t attributes;
+    if (pthread_mutexattr_init(&attributes) != 0 ||
+        pthread_mutexattr_setprotocol(&attributes, PTHREAD_PRIO_INHERIT) != 0 ||
+        pthread_mutex_init(mutex, &attributes) != 0) {
+        fprintf(stderr, "Failed to create a priority-inheritance mutex\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutexattr_destroy(&attributes);
+}
+
+// Called on the TTI thread: grows its stack to the depth it will need while still allowed to fault
+static inline void rt_prefault_stack(void) {
+    volatile char stack[RT_STACK_PREFAULT];
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < sizeof(stack); offset += page) {
+        stack[offset] = 0;
+    }
+}
+
+static inline void rt_lock_memory(rt_profile_t *rt) {
+    int ok = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    rt_report(rt, ok, "mlockall", errno);
+}
+
+// Called on the main thread before any other thread starts, so the threads it creates
+// inherit an affinity that leaves the TTI CPU alone
+static inline void rt_reserve_cpu(rt_profile_t *rt) {
+    cpu_set_t others;
+    CPU_ZERO(&others);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (rt->cpu < 0 || rt->cpu >= cpus) {
+        fprintf(stderr, "RT CPU %d does not exist (%ld online)\n", rt->cpu, cpus);
+        exit(EXIT_FAILURE);
+    }
+    for (int cpu = 0; cpu < cpus; cpu++) {
+        if (cpu != rt->cpu) {
+            CPU_SET(cpu, &others);
+        }
+    }
+    if (CPU_COUNT(&others) == 0) {
+        fprintf(stderr, "RT reserve CPU %d: FAILED (no other CPU for the remaining threads)\n", rt->cpu);
+        rt->failures++;
+        return;
+    }
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(others), &others);
+    rt_report(rt, error == 0, "keep other threads off the TTI CPU", error);
+    if (!rt_cpu_isolated(rt->cpu)) {
+        fprintf(stderr, "RT warning: CPU %d is not isolated (isolcpus), so the kernel may still place work on it\n",
+                rt->cpu);
+    }
+}
+
+// Called on the TTI thread itself
+static inline void rt_setup_thread(rt_profile_t *rt) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(rt->cpu, &set);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    char step[64];
+    snprintf(step, sizeof(step), "pin TTI thread to CPU %d", rt->cpu);
+    rt_report(rt, error == 0, step, error);
+
+    struct sched_param param = {.sched_priority = rt->priority};
+    error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    snprintf(step, sizeof(step), "SCHED_FIFO priority %d", rt->priority);
+    rt_report(rt, error == 0, step, error);
+
+    rt_prefault_stack();
+    fprintf(stderr, "RT profile: %d step(s) failed\n", rt->failures);
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef SCHED_PLUGIN_H
+#define SCHED_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// C ABI between gnb_server and scheduling policy plugins (shared objects).
+// A plugin exports SCHED_PLUGIN_ENTRY, returning a static sched_plugin_t. The server owns all
+// per-UE state (connection, MCS, DRX, average rate) and hands the policy a read-only view of
+// the awake UEs each TTI, so swapping the policy loses nothing. A policy may keep private
+// state of state_size bytes, which the server allocates zeroed when the plugin is loaded.
+//
+// Only ever add fields at the end of these structs and bump SCHED_PLUGIN_ABI_VERSION when an
+// existing field changes; the server rejects plugins built against another version.
+
+#define SCHED_PLUGIN_ABI_VERSION 1
+#define SCHED_PLUGIN_ENTRY "sched_plugin_entry"
+
+typedef struct {
+    int32_t id;             // server client slot, stable while the UE is connected
+    int32_t mcs;
+    int32_t starved;        // awake and without a grant for the SR timeout
+    int32_t reserved;
+    int64_t last_grant_tti; // -1 before the first grant
+    double average_rate;    // moving average of granted bytes per TTI
+} sched_ue_t;
+
+typedef struct {
+    int32_t ue;             // index into the candidate array
+    int32_t resource_blocks;
+} sched_grant_t;
+
+typedef struct {
+    int64_t tti;
+    int32_t num_ues;
+    int32_t resource_blocks;
+    int32_t max_grants;
+    int32_t reserved;
+    const sched_ue_t *ues;
+} sched_input_t;
+
+typedef struct {
+    uint32_t abi_version;
+    uint32_t struct_size;   // sizeof(sched_plugin_t) the plugin was built with
+    const char *name;
+    size_t state_size;
+    // Fills up to input->max_grants grants using at most input->resource_blocks RBs in total;
+    // returns the number of grants. Called from the TTI thread only.
+    int (*schedule)(void *state, const sched_input_t *input, sched_grant_t *grants);
+} sched_plugin_t;
+
+typedef const sched_plugin_t *(*sched_plugin_entry_fn)(void);
+
+#endif
@@ -5,6 +5,10 @@
 #include <pthread.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include <time.h>
+
+#include "drx.h"
+#include "tti_clock.h"
 
 #define PORT 8080
 #define MAX_CLIENTS 100
@@ -19,12 +23,16 @@ typedef struct {
     int socket;
     struct sockaddr_in address;
     int mcs;
-    int delay;
 } client_t;
 
 client_t *clients[MAX_CLIENTS];
 pthread_mutex_t clients_mutex = PTHREAD_MUTEX_INITIALIZER;
+long tti_duration_us = TTI_DURATION;
+long current_tti = 0;
+long long tti_start_ns = 0;
+tti_stats_t tti_stats;
 int connected_clients = 0;
+drx_t drx;
 
 void add_client(client_t *cl) {
     pthread_mutex_lock(&clients_mutex);
@@ -32,6 +40,7 @@ void add_client(client_t *cl) {
         if (!clients[i]) {
             clients[i] = cl;
             connected_clients++;
+            drx_attach(&drx, i);
             break;
         }
     }
@@ -45,6 +54,7 @@ void remove_client(int socket) {
             if (clients[i]->socket == socket) {
                 clients[i] = NULL;
                 connected_clients--;
+                drx_detach(&drx, i);
                 break;
             }
         }
@@ -59,7 +69,6 @@ void *handle_client(void *arg) {
 
     // Assign a random MCS value between 0 and 27
     cli->mcs = rand() % (MAX_MCS + 1);
-    cli->delay = 0;
 
     printf("Client connected with MCS %d\n", cli->mcs);
 
@@ -78,73 +87,100 @@ void *handle_client(void *arg) {
 
 void allocate_resources() {
     pthread_mutex_lock(&clients_mutex);
+    drx_tick(&drx, current_tti);
 
-    if (connected_clients == 0) {
+    if (drx.num_awake == 0) {
         pthread_mutex_unlock(&clients_mutex);
         return;
     }
 
-    for (int i = 0; i < MAX_CLIENTS; ++i) {
-        if (clients[i]) {
-            clients[i]->delay++;
-        }
-    }
-
+    // Only awake UEs are candidates: the highest MCS among those starved for MAX_TTI_DELAY
+    // TTIs, else the highest MCS overall (ties to the lowest slot)
     int max_mcs = -1;
     int selected_client = -1;
-
-    for (int i = 0; i < MAX_CLIENTS; ++i) {
-        if (clients[i] && clients[i]->delay >= MAX_TTI_DELAY) {
-            if (clients[i]->mcs > max_mcs) {
-                max_mcs = clients[i]->mcs;
-                selected_client = i;
-            }
-        }
-    }
-
-    if (selected_client == -1) {
-        for (int i = 0; i < MAX_CLIENTS; ++i) {
-            if (clients[i] && clients[i]->mcs > max_mcs) {
-                max_mcs = clients[i]->mcs;
-                selected_client = i;
-            }
+    int starved = 0;
+
+    for (int a = 0; a < drx.num_awake; ++a) {
+        int i = drx.awake[a];
+        int better = clients[i]->mcs > max_mcs || (clients[i]->mcs == max_mcs && i < selected_client);
+        if (drx.starved[i] > starved || (drx.starved[i] == starved && better)) {
+            starved = drx.starved[i];
+            max_mcs = clients[i]->mcs;
+            selected_client = i;
         }
     }
 
-    clients[selected_client]->delay = 0;
+    drx_granted(&drx, selected_client);
     printf("Allocating %d RBs to Client %d with MCS %d\n", RB_PER_TTI, clients[selected_client]->socket, clients[selected_client]->mcs);
     char message[BUFFER_SIZE];
-    snprintf(message, sizeof(message), "Allocated %d RBs", RB_PER_TTI);
+    snprintf(message, sizeof(message), "Allocated %d RBs tti=%ld t=%lld", RB_PER_TTI, current_tti, tti_start_ns);
     send(clients[selected_client]->socket, message, strlen(message) + 1, 0);
+    tti_stats.grants++;
+    tti_stats.sends++;
 
     pthread_mutex_unlock(&clients_mutex);
 }
 
 
 void *tti_scheduler(void *arg) {
-    while (1) {
-        usleep(TTI_DURATION);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while (!stop_requested) {
+        tti_advance(&deadline, tti_duration_us);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        tti_start_ns = tti_now_ns();
         printf("Starting new TTI ...\n");
         allocate_resources();
+        current_tti++;
+        tti_stats.ttis++;
+        if (tti_overran(&deadline, tti_duration_us)) {
+            tti_stats.overruns++;
+        }
+        if (stats_requested) {
+            stats_requested = 0;
+            tti_print_stats(&tti_stats, connected_clients);
+        }
     }
+
+    tti_print_stats(&tti_stats, connected_clients);
+    fflush(stdout);
+    exit(0);
     return NULL;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     int server_socket, new_socket;
     struct sockaddr_in server_addr, client_addr;
     socklen_t client_len = sizeof(client_addr);
     pthread_t tid, tti_tid;
+    int port = PORT;
+    int reuse = 1;
+
+    // Optional: TTI length in microseconds, port and DRX cycle in TTIs (0 = off), so the load
+    // benchmark can drive the server
+    if (argc > 1) {
+        tti_duration_us = atol(argv[1]);
+    }
+    if (argc > 2) {
+        port = atoi(argv[2]);
+    }
+    drx_init(&drx, MAX_CLIENTS, argc > 3 ? atoi(argv[3]) : 0, MAX_TTI_DELAY);
+    signal(SIGINT, tti_request_stop);
+    signal(SIGTERM, tti_request_stop);
+    signal(SIGUSR1, tti_request_stats);
 
     server_socket = socket(AF_INET, SOCK_STREAM, 0);
     if (server_socket == -1) {
         perror("Socket creation failed");
         exit(EXIT_FAILURE);
     }
+    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(PORT);
+    server_addr.sin_port = htons(port);
 
     if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
         perror("Socket bind failed");
@@ -158,7 +194,7 @@ int main() {
         exit(EXIT_FAILURE);
     }
 
-    printf("Server listening on port %d\n", PORT);
+    printf("Server listening on port %d\n", port);
 
     pthread_create(&tti_tid, NULL, tti_scheduler, NULL);
     pthread_detach(tti_tid);
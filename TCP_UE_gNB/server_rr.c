@@ -5,6 +5,10 @@
 #include <pthread.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include <time.h>
+
+#include "drx.h"
+#include "tti_clock.h"
 
 #define PORT 8080
 #define MAX_CLIENTS 12
@@ -20,7 +24,12 @@ typedef struct {
 
 client_t *clients[MAX_CLIENTS];
 pthread_mutex_t clients_mutex = PTHREAD_MUTEX_INITIALIZER;
-int current_client_index = 0;
+long tti_duration_us = TTI_DURATION;
+long current_tti = 0;
+long long tti_start_ns = 0;
+tti_stats_t tti_stats;
+int current_client_index = 0;   // first client slot to serve next
+drx_t drx;
 int connected_clients = 0;
 
 void add_client(client_t *cl) {
@@ -30,6 +39,7 @@ void add_client(client_t *cl) {
         if (!clients[i]) {
             clients[i] = cl;
             connected_clients++;
+            drx_attach(&drx, i);
             break;
         }
     }
@@ -45,6 +55,7 @@ void remove_client(int socket) {
             if (clients[i]->socket == socket) {
                 clients[i] = NULL;
                 connected_clients--;
+                drx_detach(&drx, i);
                 break;
             }
         }
@@ -78,58 +89,116 @@ void allocate_resources() {
 
     int allocated_clients = 0;
 
-    if (connected_clients == 0) {
+    drx_tick(&drx, current_tti);
+    if (drx.num_awake == 0) {
         pthread_mutex_unlock(&clients_mutex);
         return;
     }
     int base_rb_per_ue = 0;
-    if(connected_clients < MAX_UE_PER_TTI){ 
-        base_rb_per_ue = RB_PER_TTI / connected_clients;
+    if(drx.num_awake < MAX_UE_PER_TTI){ 
+        base_rb_per_ue = RB_PER_TTI / drx.num_awake;
     }else{
         base_rb_per_ue = RB_PER_TTI / MAX_UE_PER_TTI;
     }
 
-    for (int i = 0; i < MAX_CLIENTS && allocated_clients < MAX_UE_PER_TTI; ++i) {
-        int client_index = (current_client_index + i) % MAX_CLIENTS;
-        if (clients[client_index]) {
-            printf("Allocating %d RBs to Client %d\n", base_rb_per_ue, clients[client_index]->socket - 3);
-            char message[BUFFER_SIZE];
-            snprintf(message, sizeof(message), "Allocated %d RBs", base_rb_per_ue);
-            send(clients[client_index]->socket, message, strlen(message) + 1, 0); 
-            allocated_clients++;
+    // Round robin in client slot order over the awake UEs only: the awake set is unordered,
+    // so pick the (up to) MAX_UE_PER_TTI awake slots closest after the cursor
+    int selected[MAX_UE_PER_TTI];
+    int distance[MAX_UE_PER_TTI];
+    int num_selected = 0;
+    for (int a = 0; a < drx.num_awake; ++a) {
+        int slot = drx.awake[a];
+        int key = (slot - current_client_index + MAX_CLIENTS) % MAX_CLIENTS;
+        if (num_selected == MAX_UE_PER_TTI && key >= distance[num_selected - 1]) {
+            continue;
         }
+        int pos = num_selected < MAX_UE_PER_TTI ? num_selected++ : MAX_UE_PER_TTI - 1;
+        while (pos > 0 && distance[pos - 1] > key) {
+            distance[pos] = distance[pos - 1];
+            selected[pos] = selected[pos - 1];
+            pos--;
+        }
+        distance[pos] = key;
+        selected[pos] = slot;
     }
 
-    current_client_index = (current_client_index + allocated_clients) % connected_clients;
+    for (int i = 0; i < num_selected; ++i) {
+        int client_index = selected[i];
+        printf("Allocating %d RBs to Client %d\n", base_rb_per_ue, clients[client_index]->socket - 3);
+        char message[BUFFER_SIZE];
+        snprintf(message, sizeof(message), "Allocated %d RBs tti=%ld t=%lld", base_rb_per_ue, current_tti, tti_start_ns);
+        send(clients[client_index]->socket, message, strlen(message) + 1, 0);
+        drx_granted(&drx, client_index);
+        tti_stats.grants++;
+        tti_stats.sends++;
+        allocated_clients++;
+    }
+
+    current_client_index = (selected[num_selected - 1] + 1) % MAX_CLIENTS;
 
     pthread_mutex_unlock(&clients_mutex);
 }
 
 
 void *tti_scheduler(void *arg) {
-    while (1) {
-        usleep(TTI_DURATION);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while (!stop_requested) {
+        tti_advance(&deadline, tti_duration_us);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        tti_start_ns = tti_now_ns();
         printf("Starting new TTI ...\n");
         allocate_resources();
+        current_tti++;
+        tti_stats.ttis++;
+        if (tti_overran(&deadline, tti_duration_us)) {
+            tti_stats.overruns++;
+        }
+        if (stats_requested) {
+            stats_requested = 0;
+            tti_print_stats(&tti_stats, connected_clients);
+        }
     }
+
+    tti_print_stats(&tti_stats, connected_clients);
+    fflush(stdout);
+    exit(0);
     return NULL;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     int server_socket, new_socket;
     struct sockaddr_in server_addr, client_addr;
     socklen_t client_len = sizeof(client_addr);
     pthread_t tid, tti_tid;
+    int port = PORT;
+    int reuse = 1;
+
+    // Optional: TTI length in microseconds, port and DRX cycle in TTIs (0 = off), so the load
+    // benchmark can drive the server
+    if (argc > 1) {
+        tti_duration_us = atol(argv[1]);
+    }
+    if (argc > 2) {
+        port = atoi(argv[2]);
+    }
+    drx_init(&drx, MAX_CLIENTS, argc > 3 ? atoi(argv[3]) : 0, 0);
+    signal(SIGINT, tti_request_stop);
+    signal(SIGTERM, tti_request_stop);
+    signal(SIGUSR1, tti_request_stats);
 
     server_socket = socket(AF_INET, SOCK_STREAM, 0);
     if (server_socket == -1) {
         perror("Socket creation failed");
         exit(EXIT_FAILURE);
     }
+    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(PORT);
+    server_addr.sin_port = htons(port);
 
     if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
         perror("Socket bind failed");
@@ -143,7 +212,7 @@ int main() {
         exit(EXIT_FAILURE);
     }
 
-    printf("Server listening on port %d\n", PORT);
+    printf("Server listening on port %d\n", port);
 
     // Start TTI scheduler thread
     pthread_create(&tti_tid, NULL, tti_scheduler, NULL);
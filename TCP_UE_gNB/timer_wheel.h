@@ -0,0 +1,144 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Hierarchical timing wheel with a resolution of one TTI.
+// Four levels of 64 slots: level L holds timers due in the same 64^(L+1)-TTI block as now
+// but not the same 64^L-TTI block, in the slot for their level-L digit. Each TTI expires one
+// level-0 slot, and when a block boundary passes, the matching slot of the level above is
+// moved down (cascaded). Arming, cancelling and expiring are O(1); each timer is cascaded at
+// most three times. Timers further out than 2^24 TTIs wait on the top level and are cascaded
+// again on every lap until they fall due.
+//
+// Timers are small integer ids, 0..capacity-1, chosen by the caller, each armed at most once.
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+typedef struct {
+    long now;           // every timer due at or before now has expired
+    int capacity;
+    int count;          // armed timers
+    long *expiry;
+    int *bucket;        // level * TIMER_WHEEL_SLOTS + slot, -1 when not armed
+    int *next;
+    int *prev;
+    int head[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+} timer_wheel_t;
+
+static inline void timer_wheel_init(timer_wheel_t *wheel, int capacity, long now) {
+    wheel->now = now;
+    wheel->capacity = capacity;
+    wheel->count = 0;
+    wheel->expiry = malloc(capacity * sizeof(long));
+    wheel->bucket = malloc(capacity * sizeof(int));
+    wheel->next = malloc(capacity * sizeof(int));
+    wheel->prev = malloc(capacity * sizeof(int));
+    if (!wheel->expiry || !wheel->bucket || !wheel->next || !wheel->prev) {
+        perror("Failed to allocate timer wheel");
+        exit(EXIT_FAILURE);
+    }
+    for (int id = 0; id < capacity; id++) {
+        wheel->bucket[id] = -1;
+    }
+    for (int b = 0; b < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; b++) {
+        wheel->head[b] = -1;
+    }
+}
+
+static inline void timer_wheel_free(timer_wheel_t *wheel) {
+    free(wheel->expiry);
+    free(wheel->bucket);
+    free(wheel->next);
+    free(wheel->prev);
+}
+
+static inline int timer_wheel_armed(const timer_wheel_t *wheel, int id) {
+    return wheel->bucket[id] >= 0;
+}
+
+// Links an unarmed timer into the slot for its expiry, relative to now
+static inline void timer_wheel_link(timer_wheel_t *wheel, int id) {
+    long expiry = wheel->expiry[id];
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           (expiry >> (TIMER_WHEEL_BITS * (level + 1))) != (wheel->now >> (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    int b = level * TIMER_WHEEL_SLOTS + (int)((expiry >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+    wheel->bucket[id] = b;
+    wheel->prev[id] = -1;
+    wheel->next[id] = wheel->head[b];
+    if (wheel->head[b] >= 0) {
+        wheel->prev[wheel->head[b]] = id;
+    }
+    wheel->head[b] = id;
+}
+
+static inline void timer_wheel_cancel(timer_wheel_t *wheel, int id) {
+    int b = wheel->bucket[id];
+    if (b < 0) {
+        return;
+    }
+    if (wheel->prev[id] >= 0) {
+        wheel->next[wheel->prev[id]] = wheel->next[id];
+    } else {
+        wheel->head[b] = wheel->next[id];
+    }
+    if (wheel->next[id] >= 0) {
+        wheel->prev[wheel->next[id]] = wheel->prev[id];
+    }
+    wheel->bucket[id] = -1;
+    wheel->count--;
+}
+
+// (Re)arms a timer to expire at TTI expiry; a time already passed expires on the next TTI
+static inline void timer_wheel_arm(timer_wheel_t *wheel, int id, long expiry) {
+    timer_wheel_cancel(wheel, id);
+    wheel->expiry[id] = expiry > wheel->now ? expiry : wheel->now + 1;
+    timer_wheel_link(wheel, id);
+    wheel->count++;
+}
+
+// Advances to TTI tti and stores the ids of the timers that expired on the way in expired
+// (room for capacity ids); returns how many. Expired timers are unarmed and may be re-armed.
+static inline int timer_wheel_advance(timer_wheel_t *wheel, long tti, int *expired) {
+    int found = 0;
+    if (wheel->count == 0 && tti > wheel->now) {
+        wheel->now = tti;
+        return 0;
+    }
+    while (wheel->now < tti) {
+        long now = ++wheel->now;
+
+        // Cascade from the highest level whose block boundary this TTI crosses
+        int top = 0;
+        while (top < TIMER_WHEEL_LEVELS - 1 && (now & ((1L << (TIMER_WHEEL_BITS * (top + 1))) - 1)) == 0) {
+            top++;
+        }
+        for (int level = top; level > 0; level--) {
+            int b = level * TIMER_WHEEL_SLOTS + (int)((now >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+            int id = wheel->head[b];
+            wheel->head[b] = -1;
+            while (id >= 0) {
+                int next = wheel->next[id];
+                timer_wheel_link(wheel, id);
+                id = next;
+            }
+        }
+
+        int b = (int)(now & (TIMER_WHEEL_SLOTS - 1));
+        for (int id = wheel->head[b]; id >= 0; id = wheel->next[id]) {
+            wheel->bucket[id] = -1;
+            wheel->count--;
+            expired[found++] = id;
+        }
+        wheel->head[b] = -1;
+    }
+    return found;
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef TTI_CLOCK_H
+#define TTI_CLOCK_H
+
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+
+// TTI pacing and run statistics shared by the servers.
+// TTIs start on absolute CLOCK_MONOTONIC deadlines, so time spent allocating does not
+// stretch the TTI; a TTI whose work runs past the next deadline counts as an overrun.
+
+typedef struct {
+    long ttis;
+    long overruns;
+    long grants;
+    long sends;         // grant messages or PDUs the TTI thread wrote to sockets
+} tti_stats_t;
+
+volatile sig_atomic_t stop_requested = 0;
+volatile sig_atomic_t stats_requested = 0;
+
+// SIGINT/SIGTERM stop the TTI thread, which prints the final stats; SIGUSR1 prints a snapshot
+static inline void tti_request_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static inline void tti_request_stats(int sig) {
+    (void)sig;
+    stats_requested = 1;
+}
+
+static inline long long tti_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static inline void tti_advance(struct timespec *deadline, long period_us) {
+    deadline->tv_nsec += period_us * 1000;
+    while (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_nsec -= 1000000000L;
+        deadline->tv_sec++;
+    }
+}
+
+// Returns 1 if the TTI that started at deadline ran past the next one, and resynchronizes
+static inline int tti_overran(struct timespec *deadline, long period_us) {
+    long long now = tti_now_ns();
+    long long next = deadline->tv_sec * 1000000000LL + deadline->tv_nsec + period_us * 1000LL;
+    if (now <= next) {
+        return 0;
+    }
+    deadline->tv_sec = now / 1000000000LL;
+    deadline->tv_nsec = now % 1000000000LL;
+    return 1;
+}
+
+// Histogram of how late the TTI thread wakes up after each deadline, 1 us per bucket; the
+// last bucket also holds everything later
+#define TTI_JITTER_BUCKETS 10000
+
+typedef struct {
+    long counts[TTI_JITTER_BUCKETS];
+    long samples;
+    long long max_ns;
+} tti_jitter_t;
+
+static inline void tti_jitter_add(tti_jitter_t *jitter, const struct timespec *deadline, long long woke_ns) {
+    long long late_ns = woke_ns - (deadline->tv_sec * 1000000000LL + deadline->tv_nsec);
+    if (late_ns < 0) {
+        late_ns = 0;
+    }
+    long bucket = late_ns / 1000;
+    jitter->counts[bucket < TTI_JITTER_BUCKETS ? bucket : TTI_JITTER_BUCKETS - 1]++;
+    jitter->samples++;
+    if (late_ns > jitter->max_ns) {
+        jitter->max_ns = late_ns;
+    }
+}
+
+static inline long tti_jitter_percentile_us(const tti_jitter_t *jitter, double fraction) {
+    long target = (long)(fraction * jitter->samples);
+    long seen = 0;
+    for (long bucket = 0; bucket < TTI_JITTER_BUCKETS; bucket++) {
+        seen += jitter->counts[bucket];
+        if (seen > target) {
+            return bucket;
+        }
+    }
+    return TTI_JITTER_BUCKETS - 1;
+}
+
+static inline void tti_print_jitter(const tti_jitter_t *jitter) {
+    fprintf(stderr, "JITTER samples=%ld p50_us=%ld p99_us=%ld p999_us=%ld max_us=%lld\n", jitter->samples,
+            tti_jitter_percentile_us(jitter, 0.5), tti_jitter_percentile_us(jitter, 0.99),
+            tti_jitter_percentile_us(jitter, 0.999), jitter->max_ns / 1000);
+}
+
+// ues is the number of UEs connected (admitted) when the line is printed
+static inline void tti_print_stats(const tti_stats_t *stats, int ues) {
+    fprintf(stderr, "STATS ttis=%ld overruns=%ld grants=%ld sends=%ld ues=%d\n",
+            stats->ttis, stats->overruns, stats->grants, stats->sends, ues);
+}
+
+#endif
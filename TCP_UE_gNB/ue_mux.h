@@ -0,0 +1,64 @@
+#ifndef UE_MUX_H
+#define UE_MUX_H
+
+#include <stdio.h>
+#include <string.h>
+
+// Wire format for multiplexed connections, where one TCP connection carries a block of UEs.
+// Messages are NUL-terminated text like the plain "Allocated ..." grants:
+//   client -> server   "MUX <count>"                          ask for count UEs on this connection
+//   server -> client   "MUX first=<id> n=<count>"              the UE ids granted to it
+//   server -> client   "Grants tti=<tti> t=<ns> <id>:<rbs> ..."  every grant of one TTI to its UEs
+// The server sends at most one grant PDU per connection per TTI; the client demultiplexes it
+// by UE id. A connection that never sends MUX is a single UE with plain grants.
+
+#define MUX_MAX_UES 16384
+#define MUX_PDU_SIZE 1024
+
+typedef struct {
+    int length;
+    int grants;
+    char text[MUX_PDU_SIZE];
+} mux_pdu_t;
+
+static inline void mux_pdu_begin(mux_pdu_t *pdu, long tti, long long tti_start_ns) {
+    pdu->length = snprintf(pdu->text, sizeof(pdu->text), "Grants tti=%ld t=%lld", tti, tti_start_ns);
+    pdu->grants = 0;
+}
+
+// Returns 0 when the PDU is full and has to be sent first
+static inline int mux_pdu_add(mux_pdu_t *pdu, int ue, int resource_blocks) {
+    int room = (int)sizeof(pdu->text) - pdu->length;
+    int written = snprintf(pdu->text + pdu->length, room, " %d:%d", ue, resource_blocks);
+    if (written >= room) {
+        pdu->text[pdu->length] = '\0';
+        return 0;
+    }
+    pdu->length += written;
+    pdu->grants++;
+    return 1;
+}
+
+// Bytes to send, including the terminating NUL
+static inline int mux_pdu_bytes(const mux_pdu_t *pdu) {
+    return pdu->length + 1;
+}
+
+// Parses a grant PDU into at most max (ue, rbs) pairs; returns the number of pairs, or -1
+// if message is not a grant PDU
+static inline int mux_parse_grants(const char *message, long *tti, long long *tti_start_ns, int *ues,
+                                   int *resource_blocks, int max) {
+    int offset;
+    if (sscanf(message, "Grants tti=%ld t=%lld%n", tti, tti_start_ns, &offset) != 2) {
+        return -1;
+    }
+    int count = 0;
+    int used;
+    while (count < max && sscanf(message + offset, " %d:%d%n", &ues[count], &resource_blocks[count], &used) == 2) {
+        offset += used;
+        count++;
+    }
+    return count;
+}
+
+#endif
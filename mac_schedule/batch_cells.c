@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <immintrin.h>
+
+#include "scenario.h"
+#include "channel_model.h"
+
+// Runs CELL_LANES independent cells in lock-step, one cell per SIMD lane.
+// Every per-user field is stored as [user][lane], so a scheduler decision for all
+// cells is a handful of vector compares and one TBSArray gather per user.
+//
+// Users, users_per_tti, ttis, scheduling_interval, policy and resource_blocks come from the
+// scenario; each batch is seeded with seed + batch.
+//
+// Build: gcc -O3 -ffast-math -march=native batch_cells.c -o batch_cells -lm
+// Usage: ./batch_cells <scenario> <num_batches> [rb_min] [rb_max] [--scalar]
+
+#if defined(__AVX512F__)
+#define CELL_LANES 16
+#else
+#define CELL_LANES 8
+#endif
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+
+typedef int32_t lane_i32 __attribute__((vector_size(CELL_LANES * sizeof(int32_t))));
+typedef int64_t lane_i64 __attribute__((vector_size(CELL_LANES * sizeof(int64_t))));
+
+enum { POLICY_RR, POLICY_MAXCI, POLICY_PF };
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
+
+// Per-user fields are indexed [user][lane], scenario.users rows each, allocated once
+typedef struct {
+    lane_i32 *mcs_index;
+    lane_i32 *last_scheduled_tti;
+    lane_i32 *total_resource_blocks;
+    lane_i32 *times_scheduled;
+    lane_i64 *total_data_transmitted;
+    lane_i32 *key;                  // scheduler scratch
+    lane_i32 *rank;
+    lane_i32 cell_resource_blocks;
+} CellBatch;
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+void alloc_batch(CellBatch *batch);
+void free_batch(CellBatch *batch);
+void init_batch(CellBatch *batch, int rb_min, int rb_max);
+void load_channel_mcs(CellBatch *batch, const ChannelModel *channel);
+void batch_scheduler(CellBatch *batch, int policy, int current_tti);
+void scalar_scheduler(CellBatch *batch, int policy, int current_tti);
+int parse_policy(const char *name);
+
+static inline lane_i32 gather_tbs(lane_i32 index) {
+#if defined(__AVX512F__)
+    return (lane_i32)_mm512_i32gather_epi32((__m512i)index, &TBSArray[0][0], 4);
+#elif defined(__AVX2__)
+    return (lane_i32)_mm256_i32gather_epi32(&TBSArray[0][0], (__m256i)index, 4);
+#else
+    lane_i32 result;
+    for (int lane = 0; lane < CELL_LANES; lane++) {
+        result[lane] = (&TBSArray[0][0])[index[lane]];
+    }
+    return result;
+#endif
+}
+
+int main(int argc, char *argv[]) {
+    // --scalar may come anywhere; it is taken out so the positional arguments keep their places
+    int scalar = 0;
+    int positional = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--scalar") == 0) {
+            scalar = 1;
+        } else {
+            argv[positional++] = argv[i];
+        }
+    }
+    argc = positional;
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <scenario> <num_batches> [rb_min] [rb_max] [--scalar]\n", argv[0]);
+        return 1;
+    }
+
+    load_scenario(argv[1], &scenario);
+    int policy = parse_policy(scenario.policy);
+    int num_batches = atoi(argv[2]);
+    int rb_min = argc > 3 ? atoi(argv[3]) : scenario.resource_blocks;
+    int rb_max = argc > 4 ? atoi(argv[4]) : rb_min;
+    int num_users = scenario.users;
+    int total_ttis = scenario.ttis;
+    unsigned int seed = scenario_seed(&scenario);
+
+    if (policy < 0) {
+        fprintf(stderr, "Unknown policy '%s'\n", scenario.policy);
+        return 1;
+    }
+    if (num_batches <= 0 || rb_min < scenario.users_per_tti || rb_max > MAX_RB || rb_min > rb_max) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    generate_TBSArray(TBSArray);
+
+    CellBatch *batch = aligned_alloc(64, sizeof(CellBatch));
+    alloc_batch(batch);
+    double cell_throughput[CELL_LANES] = {0};
+    struct timespec start, end;
+    double scheduling_time = 0;
+
+    printf("THIS IS BATCHED CELL SIMULATION (%d cells per batch, %s kernel)\n", CELL_LANES, scalar ? "scalar" : "SIMD");
+
+    for (int b = 0; b < num_batches; b++) {
+        // One channel model covers every cell; UE u of cell l is entry u * CELL_LANES + l
+        ChannelModel channel;
+        channel_model_init(&channel, num_users * CELL_LANES, seed + (uint32_t)b);
+        init_batch(batch, rb_min, rb_max);
+
+        for (int tti = 0; tti < total_ttis; tti++) {
+            channel_model_step(&channel);
+            load_channel_mcs(batch, &channel);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            if (scalar) {
+                scalar_scheduler(batch, policy, tti);
+            } else {
+                batch_scheduler(batch, policy, tti);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            scheduling_time += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        }
+
+        for (int lane = 0; lane < CELL_LANES; lane++) {
+            long long total_bytes = 0;
+            for (int u = 0; u < num_users; u++) {
+                total_bytes += batch->total_data_transmitted[u][lane];
+            }
+            cell_throughput[lane] += (total_bytes * 8 / 1000000) / (total_ttis * TTI_DURATION);
+        }
+        channel_model_free(&channel);
+    }
+
+    for (int lane = 0; lane < CELL_LANES; lane++) {
+        printf("Cell %d: RBs per TTI = %d, Average throughput over %d runs = %.3f Mbps\n",
+               lane, batch->cell_resource_blocks[lane], num_batches, cell_throughput[lane] / num_batches);
+    }
+
+    double cell_ttis = (double)num_batches * total_ttis * CELL_LANES;
+    printf("\nScheduled %.0f cell-TTIs in %.3f s (%.1f ns per cell-TTI)\n", cell_ttis, scheduling_time, scheduling_time * 1e9 / cell_ttis);
+
+    free_batch(batch);
+    free(batch);
+    return 0;
+}
+
+int parse_policy(const char *name) {
+    if (strcmp(name, "rr") == 0) {
+        return POLICY_RR;
+    }
+    if (strcmp(name, "maxci") == 0) {
+        return POLICY_MAXCI;
+    }
+    if (strcmp(name, "pf") == 0) {
+        return POLICY_PF;
+    }
+    return -1;
+}
+
+static void *alloc_lanes(int rows, size_t row_size) {
+    // aligned_alloc wants a multiple of the alignment
+    size_t size = ((size_t)rows * row_size + 63) / 64 * 64;
+    void *ptr = aligned_alloc(64, size);
+    if (ptr == NULL) {
+        perror("Failed to allocate cell batch");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+void alloc_batch(CellBatch *batch) {
+    int n = scenario.users;
+    batch->mcs_index = alloc_lanes(n, sizeof(lane_i32));
+    batch->last_scheduled_tti = alloc_lanes(n, sizeof(lane_i32));
+    batch->total_resource_blocks = alloc_lanes(n, sizeof(lane_i32));
+    batch->times_scheduled = alloc_lanes(n, sizeof(lane_i32));
+    batch->total_data_transmitted = alloc_lanes(n, sizeof(lane_i64));
+    batch->key = alloc_lanes(n, sizeof(lane_i32));
+    batch->rank = alloc_lanes(n, sizeof(lane_i32));
+}
+
+void free_batch(CellBatch *batch) {
+    free(batch->mcs_index);
+    free(batch->last_scheduled_tti);
+    free(batch->total_resource_blocks);
+    free(batch->times_scheduled);
+    free(batch->total_data_transmitted);
+    free(batch->key);
+    free(batch->rank);
+}
+
+void init_batch(CellBatch *batch, int rb_min, int rb_max) {
+    int n = scenario.users;
+    memset(batch->mcs_index, 0, n * sizeof(lane_i32));
+    memset(batch->total_resource_blocks, 0, n * sizeof(lane_i32));
+    memset(batch->times_scheduled, 0, n * sizeof(lane_i32));
+    memset(batch->total_data_transmitted, 0, n * sizeof(lane_i64));
+    for (int u = 0; u < n; u++) {
+        for (int lane = 0; lane < CELL_LANES; lane++) {
+            batch->last_scheduled_tti[u][lane] = -1;
+        }
+    }
+    // Spread the bandwidth across the lanes so one batch is also a parameter sweep
+    for (int lane = 0; lane < CELL_LANES; lane++) {
+        batch->cell_resource_blocks[lane] = rb_min + (rb_max - rb_min) * lane / (CELL_LANES > 1 ? CELL_LANES - 1 : 1);
+    }
+}
+
+void load_channel_mcs(CellBatch *batch, const ChannelModel *channel) {
+    for (int u = 0; u < scenario.users; u++) {
+        for (int lane = 0; lane < CELL_LANES; lane++) {
+            batch->mcs_index[u][lane] = channel->mcs[u * CELL_LANES + lane];
+        }
+    }
+}
+
+// Same decisions as the single-cell simulators: RR walks a window of users_per_tti users,
+// Max C/I takes the highest MCS, PF serves users starved for scheduling_interval TTIs first.
+// Each user's rank is counted with pairwise compares instead of sorting, which is branch-free
+// across lanes; ties go to the lower user index.
+void batch_scheduler(CellBatch *batch, int policy, int current_tti) {
+    int num_users = scenario.users;
+    int users_per_tti = scenario.users_per_tti;
+    lane_i32 *key = batch->key;
+    lane_i32 *rank = batch->rank;
+    lane_i32 blocks_per_user = batch->cell_resource_blocks / users_per_tti;
+    lane_i32 remaining_blocks = batch->cell_resource_blocks % users_per_tti;
+
+    if (policy == POLICY_RR) {
+        int start_index = (int)((long long)current_tti * users_per_tti % num_users);
+        for (int u = 0; u < num_users; u++) {
+            rank[u] = (lane_i32){0} + (u - start_index + num_users) % num_users;
+        }
+    } else {
+        for (int u = 0; u < num_users; u++) {
+            key[u] = batch->mcs_index[u];
+            if (policy == POLICY_PF) {
+                lane_i32 delayed = (current_tti - batch->last_scheduled_tti[u]) >= scenario.scheduling_interval;
+                key[u] |= delayed & 0x100;
+            }
+        }
+        for (int u = 0; u < num_users; u++) {
+            lane_i32 r = {0};
+            for (int v = 0; v < u; v++) {
+                r -= key[v] >= key[u];
+            }
+            for (int v = u + 1; v < num_users; v++) {
+                r -= key[v] > key[u];
+            }
+            rank[u] = r;
+        }
+    }
+
+    for (int u = 0; u < num_users; u++) {
+        lane_i32 selected = rank[u] < users_per_tti;
+        lane_i32 extra = rank[u] < remaining_blocks;
+        lane_i32 row = batch->mcs_index[u] * (MAX_RB + 1);
+
+        lane_i32 data = (gather_tbs(row + blocks_per_user) & selected) + (gather_tbs(row + 1) & extra);
+        batch->total_data_transmitted[u] += __builtin_convertvector(data, lane_i64);
+        batch->total_resource_blocks[u] += (blocks_per_user & selected) - extra;
+        batch->times_scheduled[u] -= selected + extra;
+        batch->last_scheduled_tti[u] = (selected & current_tti) | (~selected & batch->last_scheduled_tti[u]);
+    }
+}
+
+// Lane-at-a-time version of batch_scheduler, kept as the reference for results and timing
+void scalar_scheduler(CellBatch *batch, int policy, int current_tti) {
+    int num_users = scenario.users;
+    int users_per_tti = scenario.users_per_tti;
+    for (int lane = 0; lane < CELL_LANES; lane++) {
+        // One lane of the vector scratch at a time
+        lane_i32 *key = batch->key;
+        lane_i32 *rank = batch->rank;
+        int total_resource_blocks = batch->cell_resource_blocks[lane];
+        int blocks_per_user = total_resource_blocks / users_per_tti;
+        int remaining_blocks = total_resource_blocks % users_per_tti;
+
+        for (int u = 0; u < num_users; u++) {
+            key[u][lane] = batch->mcs_index[u][lane];
+            if (policy == POLICY_PF && current_tti - batch->last_scheduled_tti[u][lane] >= scenario.scheduling_interval) {
+                key[u][lane] |= 0x100;
+            }
+        }
+        for (int u = 0; u < num_users; u++) {
+            if (policy == POLICY_RR) {
+                rank[u][lane] = (u - (int)((long long)current_tti * users_per_tti % num_users) + num_users) % num_users;
+                continue;
+            }
+            rank[u][lane] = 0;
+            for (int v = 0; v < num_users; v++) {
+                if (key[v][lane] > key[u][lane] || (key[v][lane] == key[u][lane] && v < u)) {
+                    rank[u][lane]++;
+                }
+            }
+        }
+
+        for (int u = 0; u < num_users; u++) {
+            int mcs = batch->mcs_index[u][lane];
+            if (rank[u][lane] < users_per_tti) {
+                batch->total_resource_blocks[u][lane] += blocks_per_user;
+                batch->times_scheduled[u][lane] += 1;
+                batch->total_data_transmitted[u][lane] += TBSArray[mcs][blocks_per_user];
+                batch->last_scheduled_tti[u][lane] = current_tti;
+            }
+            if (rank[u][lane] < remaining_blocks) {
+                batch->total_resource_blocks[u][lane] += 1;
+                batch->times_scheduled[u][lane] += 1;
+                batch->total_data_transmitted[u][lane] += TBSArray[mcs][1];
+            }
+        }
+    }
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
@@ -0,0 +1,287 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scenario.h"
+#include "channel_model.h"
+#include "scheduler_policy.h"
+
+// Proportional fair scheduling over several component carriers. Each carrier has its own
+// RB grid and its own fast fading, so a UE sees a different MCS on every carrier, but the
+// PF average is per UE across all carriers: a UE that was served well on one carrier ranks
+// lower on the others from the next TTI on.
+//
+// Every carrier is scheduled on its own thread. Within a TTI the carriers only read the
+// shared averages, and write grants into their own per-UE array; after a barrier each
+// thread merges a slice of the UEs (sums the carriers' grants, updates the average) and a
+// second barrier starts the next TTI. The result does not depend on how the carriers are
+// spread over threads, and a run takes about as long as the slowest carrier.
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+#define PF_AVERAGING_TTIS 100.0f
+
+typedef struct {
+    int index;
+    int resource_blocks;
+    ChannelModel channel;
+    int *selected;
+    float *keys;
+    int *granted;           // bytes per UE in the current TTI, cleared by the merge
+    long long bytes;
+    double schedule_ns;     // time spent stepping the channel and scheduling
+    long long multi_carrier_grants;  // UEs of this thread's merge slice served on more than one carrier
+    pthread_t thread;
+} Carrier;
+
+typedef struct {
+    double cell_throughput;
+    double fairness;
+    double multi_carrier_ues;
+    double ns_per_tti;
+    double slowest_carrier_ns;
+    double carrier_throughput[SCENARIO_MAX_CARRIERS];
+} CaResult;
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
+int num_carriers;
+Carrier *carriers;
+float *average_rate;
+long long *ue_bytes;
+pthread_barrier_t tti_barrier;
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+double now_ns();
+void init_carrier(Carrier *carrier, int index, int resource_blocks, unsigned int seed);
+void free_carrier(Carrier *carrier);
+void schedule_carrier(Carrier *carrier);
+void merge_grants(Carrier *carrier);
+void *carrier_thread(void *arg);
+CaResult run(int threaded, unsigned int seed);
+
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
+    generate_TBSArray(TBSArray);
+    unsigned int seed = scenario_seed(&scenario);
+
+    if (scenario.num_carriers == 0) {
+        scenario.carrier_rbs[0] = scenario.resource_blocks;
+        scenario.num_carriers = 1;
+    }
+    num_carriers = scenario.num_carriers;
+
+    printf("THIS IS CARRIER AGGREGATION PROPORTIONAL FAIR SCHEDULING (%d UEs, %d per carrier per TTI, carriers:",
+           scenario.users, scenario.users_per_tti);
+    for (int c = 0; c < num_carriers; c++) {
+        printf(" %d", scenario.carrier_rbs[c]);
+    }
+    printf(" RBs)\n");
+
+    CaResult threaded = run(1, seed);
+    CaResult serial = run(0, seed);
+
+    printf("\n%-8s %8s %18s\n", "Carrier", "RBs", "Throughput (Mbps)");
+    for (int c = 0; c < num_carriers; c++) {
+        printf("%-8d %8d %18.3f\n", c, scenario.carrier_rbs[c], threaded.carrier_throughput[c]);
+    }
+
+    printf("\n%-10s %18s %10s %16s %12s %20s\n", "", "Throughput (Mbps)", "Fairness", "CA UEs per TTI",
+           "ns per TTI", "slowest carrier ns");
+    printf("%-10s %18.3f %10.4f %16.2f %12.0f %20.0f\n", "threaded", threaded.cell_throughput, threaded.fairness,
+           threaded.multi_carrier_ues, threaded.ns_per_tti, threaded.slowest_carrier_ns);
+    printf("%-10s %18.3f %10.4f %16.2f %12.0f %20.0f\n", "serial", serial.cell_throughput, serial.fairness,
+           serial.multi_carrier_ues, serial.ns_per_tti, serial.slowest_carrier_ns);
+    printf("\nThreaded and serial runs %s\n",
+           threaded.cell_throughput == serial.cell_throughput && threaded.fairness == serial.fairness ? "match" : "DIFFER");
+    return 0;
+}
+
+double now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// All carriers start from the same seed, so UE positions, mobility and shadowing are shared;
+// each then gets its own fast fading streams, which is what differs between carriers
+void init_carrier(Carrier *carrier, int index, int resource_blocks, unsigned int seed) {
+    int num_users = scenario.users;
+    carrier->index = index;
+    carrier->resource_blocks = resource_blocks;
+    carrier->selected = malloc(scenario.users_per_tti * sizeof(int));
+    carrier->keys = malloc(scenario.users_per_tti * sizeof(float));
+    carrier->granted = calloc(num_users, sizeof(int));
+    carrier->bytes = 0;
+    carrier->schedule_ns = 0;
+    carrier->multi_carrier_grants = 0;
+    if (carrier->selected == NULL || carrier->keys == NULL || carrier->granted == NULL) {
+        perror("Failed to allocate carrier");
+        exit(EXIT_FAILURE);
+    }
+
+    ChannelModel *channel = &carrier->channel;
+    channel_model_init(channel, num_users, seed);
+    channel_model_split_fading(channel, (uint32_t)index);
+}
+
+void free_carrier(Carrier *carrier) {
+    free(carrier->selected);
+    free(carrier->keys);
+    free(carrier->granted);
+    channel_model_free(&carrier->channel);
+}
+
+// PF over the joint average: the users_per_tti best rate/average UEs split the carrier's RBs
+void schedule_carrier(Carrier *carrier) {
+    double start = now_ns();
+    channel_model_step(&carrier->channel);
+
+    int num_users = scenario.users;
+    int count = scenario.users_per_tti;
+    int per_user = carrier->resource_blocks / count;
+    int extra = carrier->resource_blocks % count;
+    const uint8_t *mcs = carrier->channel.mcs;
+    int *selected = carrier->selected;
+    float *keys = carrier->keys;
+
+    int found = 0;
+    for (int i = 0; i < num_users; i++) {
+        float key = TBSArray[mcs[i]][per_user > 0 ? per_user : 1] / average_rate[i];
+        scheduler_top_k_float(key, i, count, &found, keys, selected);
+    }
+
+    for (int s = 0; s < found; s++) {
+        int blocks = per_user + (s < extra);
+        if (blocks == 0) {
+            break;
+        }
+        int ue = selected[s];
+        int tbs = TBSArray[mcs[ue]][blocks];
+        carrier->granted[ue] = tbs;
+        carrier->bytes += tbs;
+    }
+    carrier->schedule_ns += now_ns() - start;
+}
+
+// Folds every carrier's grants for this thread's slice of UEs into the joint averages
+void merge_grants(Carrier *carrier) {
+    int num_users = scenario.users;
+    int first = (int)((long long)num_users * carrier->index / num_carriers);
+    int last = (int)((long long)num_users * (carrier->index + 1) / num_carriers);
+
+    for (int ue = first; ue < last; ue++) {
+        int total = 0;
+        int served_on = 0;
+        for (int c = 0; c < num_carriers; c++) {
+            int granted = carriers[c].granted[ue];
+            total += granted;
+            served_on += granted > 0;
+            carriers[c].granted[ue] = 0;
+        }
+        ue_bytes[ue] += total;
+        average_rate[ue] = average_rate[ue] * (1.0f - 1.0f / PF_AVERAGING_TTIS) + total / PF_AVERAGING_TTIS;
+        carrier->multi_carrier_grants += served_on > 1;
+    }
+}
+
+void *carrier_thread(void *arg) {
+    Carrier *carrier = (Carrier *)arg;
+    for (int tti = 0; tti < scenario.ttis; tti++) {
+        schedule_carrier(carrier);
+        pthread_barrier_wait(&tti_barrier);
+        merge_grants(carrier);
+        pthread_barrier_wait(&tti_barrier);
+    }
+    return NULL;
+}
+
+// threaded = 0 runs the same two phases for every carrier in turn on the calling thread
+CaResult run(int threaded, unsigned int seed) {
+    int num_users = scenario.users;
+    carriers = malloc(num_carriers * sizeof(Carrier));
+    average_rate = malloc(num_users * sizeof(float));
+    ue_bytes = calloc(num_users, sizeof(long long));
+    if (carriers == NULL || average_rate == NULL || ue_bytes == NULL) {
+        perror("Failed to allocate UE state");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < num_users; i++) {
+        average_rate[i] = 1.0f;
+    }
+    for (int c = 0; c < num_carriers; c++) {
+        init_carrier(&carriers[c], c, scenario.carrier_rbs[c], seed);
+    }
+
+    double start = now_ns();
+    if (threaded) {
+        pthread_barrier_init(&tti_barrier, NULL, num_carriers);
+        for (int c = 1; c < num_carriers; c++) {
+            if (pthread_create(&carriers[c].thread, NULL, carrier_thread, &carriers[c]) != 0) {
+                perror("Failed to start carrier thread");
+                exit(EXIT_FAILURE);
+            }
+        }
+        carrier_thread(&carriers[0]);
+        for (int c = 1; c < num_carriers; c++) {
+            pthread_join(carriers[c].thread, NULL);
+        }
+        pthread_barrier_destroy(&tti_barrier);
+    } else {
+        for (int tti = 0; tti < scenario.ttis; tti++) {
+            for (int c = 0; c < num_carriers; c++) {
+                schedule_carrier(&carriers[c]);
+            }
+            for (int c = 0; c < num_carriers; c++) {
+                merge_grants(&carriers[c]);
+            }
+        }
+    }
+    double elapsed_ns = now_ns() - start;
+
+    double sum = 0, sum_squares = 0;
+    for (int i = 0; i < num_users; i++) {
+        sum += ue_bytes[i];
+        sum_squares += (double)ue_bytes[i] * ue_bytes[i];
+    }
+    long long multi_carrier_grants = 0;
+    double slowest_ns = 0;
+    for (int c = 0; c < num_carriers; c++) {
+        multi_carrier_grants += carriers[c].multi_carrier_grants;
+        if (carriers[c].schedule_ns > slowest_ns) {
+            slowest_ns = carriers[c].schedule_ns;
+        }
+    }
+
+    CaResult result;
+    result.cell_throughput = (sum * 8 / 1000000.0) / (scenario.ttis * TTI_DURATION);
+    result.fairness = sum_squares > 0 ? sum * sum / (num_users * sum_squares) : 0;
+    result.multi_carrier_ues = (double)multi_carrier_grants / scenario.ttis;
+    result.ns_per_tti = elapsed_ns / scenario.ttis;
+    result.slowest_carrier_ns = slowest_ns / scenario.ttis;
+
+    for (int c = 0; c < num_carriers; c++) {
+        result.carrier_throughput[c] = (carriers[c].bytes * 8 / 1000000.0) / (scenario.ttis * TTI_DURATION);
+        free_carrier(&carriers[c]);
+    }
+    free(carriers);
+    free(average_rate);
+    free(ue_bytes);
+    return result;
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
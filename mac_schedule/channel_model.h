@@ -0,0 +1,292 @@
+#ifndef CHANNEL_MODEL_H
+#define CHANNEL_MODEL_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Time-correlated channel model: per-UE pathloss from a random-walk position,
+// Gudmundson-correlated log-normal shadowing and Rayleigh fast fading whose
+// one-TTI correlation follows Jakes (J0(2*pi*fd*T)). SINR is mapped to CQI and MCS.
+//
+// State is kept as one array per field so the per-TTI update is a straight loop over
+// UEs that the compiler turns into SIMD code (build with -O3 -ffast-math -march=native).
+
+#define CHANNEL_TTI_S 0.001f
+#define CHANNEL_CARRIER_HZ 2.0e9
+#define CHANNEL_SPEED_OF_LIGHT 3.0e8
+#define CHANNEL_CELL_RADIUS_M 1000.0f
+#define CHANNEL_MIN_DISTANCE_M 35.0f
+#define CHANNEL_TX_POWER_DBM 46.0f
+#define CHANNEL_NOISE_INTERFERENCE_DBM -87.0f
+#define CHANNEL_SHADOWING_STD_DB 8.0f
+#define CHANNEL_SHADOWING_DECORR_M 50.0f
+#define CHANNEL_MIN_SPEED_KMH 3.0f
+#define CHANNEL_MAX_SPEED_KMH 60.0f
+#define CQI_COUNT 16
+
+#define CHANNEL_TRACE_MAGIC "MCST"
+
+// SINR (dB) needed for CQI 1..15 at 10% BLER
+static const float cqi_sinr_threshold_db[CQI_COUNT - 1] = {
+    -6.7f, -4.7f, -2.3f, 0.2f, 2.4f, 4.3f, 5.9f, 8.1f,
+    10.3f, 11.7f, 14.1f, 16.3f, 18.7f, 21.0f, 22.7f
+};
+
+static const int cqi_to_mcs[CQI_COUNT] = {
+    0, 0, 2, 4, 6, 8, 11, 13, 15, 18, 20, 22, 24, 26, 27, 28
+};
+
+typedef struct {
+    int num_ues;
+    float *pos_x;
+    float *pos_y;
+    float *vel_x;
+    float *vel_y;
+    float *shadowing_db;
+    float *shadowing_rho;
+    float *shadowing_innov;
+    float *fading_re;
+    float *fading_im;
+    float *fading_rho;
+    float *fading_innov;
+    uint32_t *rng;
+    uint32_t *fading_rng;           // NULL: fast fading draws from rng as well
+    float *sinr_db;
+    uint8_t *cqi;
+    uint8_t *mcs;
+} ChannelModel;
+
+typedef struct {
+    char magic[4];
+    uint32_t num_ues;
+    uint32_t num_ttis;
+} ChannelTraceHeader;
+
+static inline uint32_t channel_rng_next(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static inline float channel_rng_uniform(uint32_t *state) {
+    return (channel_rng_next(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Sum of four uniforms, rescaled to unit variance; branch-free so it vectorizes
+static inline float channel_rng_gaussian(uint32_t *state) {
+    float sum = channel_rng_uniform(state) + channel_rng_uniform(state) +
+                channel_rng_uniform(state) + channel_rng_uniform(state);
+    return (sum - 2.0f) * 1.7320508f;
+}
+
+static inline void *channel_alloc(size_t count, size_t size) {
+    void *ptr = aligned_alloc(64, ((count * size + 63) / 64) * 64 + 64);
+    if (ptr == NULL) {
+        perror("Failed to allocate channel state");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static inline void channel_model_init(ChannelModel *channel, int num_ues, uint32_t seed) {
+    channel->num_ues = num_ues;
+    channel->pos_x = channel_alloc(num_ues, sizeof(float));
+    channel->pos_y = channel_alloc(num_ues, sizeof(float));
+    channel->vel_x = channel_alloc(num_ues, sizeof(float));
+    channel->vel_y = channel_alloc(num_ues, sizeof(float));
+    channel->shadowing_db = channel_alloc(num_ues, sizeof(float));
+    channel->shadowing_rho = channel_alloc(num_ues, sizeof(float));
+    channel->shadowing_innov = channel_alloc(num_ues, sizeof(float));
+    channel->fading_re = channel_alloc(num_ues, sizeof(float));
+    channel->fading_im = channel_alloc(num_ues, sizeof(float));
+    channel->fading_rho = channel_alloc(num_ues, sizeof(float));
+    channel->fading_innov = channel_alloc(num_ues, sizeof(float));
+    channel->rng = channel_alloc(num_ues, sizeof(uint32_t));
+    channel->fading_rng = NULL;
+    channel->sinr_db = channel_alloc(num_ues, sizeof(float));
+    channel->cqi = channel_alloc(num_ues, sizeof(uint8_t));
+    channel->mcs = channel_alloc(num_ues, sizeof(uint8_t));
+
+    double wavelength = CHANNEL_SPEED_OF_LIGHT / CHANNEL_CARRIER_HZ;
+    for (int i = 0; i < num_ues; i++) {
+        // Independent stream per UE; xorshift must never be seeded with 0
+        uint32_t state = (seed ^ 0x9E3779B9u) + (uint32_t)i * 0x85EBCA6Bu;
+        if (state == 0) {
+            state = 1;
+        }
+        for (int k = 0; k < 4; k++) {
+            channel_rng_next(&state);
+        }
+
+        // Uniform position over the cell area, random heading and speed
+        float radius = sqrtf(channel_rng_uniform(&state)) * CHANNEL_CELL_RADIUS_M;
+        float angle = channel_rng_uniform(&state) * 6.2831853f;
+        float heading = channel_rng_uniform(&state) * 6.2831853f;
+        float speed_kmh = CHANNEL_MIN_SPEED_KMH + channel_rng_uniform(&state) * (CHANNEL_MAX_SPEED_KMH - CHANNEL_MIN_SPEED_KMH);
+        float speed = speed_kmh / 3.6f;
+        channel->pos_x[i] = radius * cosf(angle);
+        channel->pos_y[i] = radius * sinf(angle);
+        channel->vel_x[i] = speed * cosf(heading);
+        channel->vel_y[i] = speed * sinf(heading);
+
+        float shadowing_rho = expf(-speed * CHANNEL_TTI_S / CHANNEL_SHADOWING_DECORR_M);
+        channel->shadowing_rho[i] = shadowing_rho;
+        channel->shadowing_innov[i] = CHANNEL_SHADOWING_STD_DB * sqrtf(1.0f - shadowing_rho * shadowing_rho);
+        channel->shadowing_db[i] = CHANNEL_SHADOWING_STD_DB * channel_rng_gaussian(&state);
+
+        double doppler_hz = speed / wavelength;
+        float fading_rho = (float)j0(2.0 * M_PI * doppler_hz * CHANNEL_TTI_S);
+        channel->fading_rho[i] = fading_rho;
+        channel->fading_innov[i] = sqrtf((1.0f - fading_rho * fading_rho) * 0.5f);
+        channel->fading_re[i] = channel_rng_gaussian(&state) * 0.70710678f;
+        channel->fading_im[i] = channel_rng_gaussian(&state) * 0.70710678f;
+
+        channel->rng[i] = state;
+    }
+}
+
+static inline void channel_model_free(ChannelModel *channel) {
+    free(channel->pos_x);
+    free(channel->pos_y);
+    free(channel->vel_x);
+    free(channel->vel_y);
+    free(channel->shadowing_db);
+    free(channel->shadowing_rho);
+    free(channel->shadowing_innov);
+    free(channel->fading_re);
+    free(channel->fading_im);
+    free(channel->fading_rho);
+    free(channel->fading_innov);
+    free(channel->rng);
+    free(channel->fading_rng);
+    free(channel->sinr_db);
+    free(channel->cqi);
+    free(channel->mcs);
+}
+
+// Gives fast fading its own per-UE streams, keyed on stream, and redraws the current fading
+// from them. Position, mobility and shadowing stay on the seed's streams, so channels built from
+// one seed with different keys (carriers of one cell) share the large-scale channel and fade
+// independently.
+static inline void channel_model_split_fading(ChannelModel *channel, uint32_t stream) {
+    channel->fading_rng = channel_alloc(channel->num_ues, sizeof(uint32_t));
+    for (int i = 0; i < channel->num_ues; i++) {
+        uint32_t state = channel->rng[i] ^ ((stream + 1) * 0x9E3779B9u);
+        if (state == 0) {
+            state = 1;
+        }
+        for (int k = 0; k < 4; k++) {
+            channel_rng_next(&state);
+        }
+        channel->fading_re[i] = channel_rng_gaussian(&state) * 0.70710678f;
+        channel->fading_im[i] = channel_rng_gaussian(&state) * 0.70710678f;
+        channel->fading_rng[i] = state;
+    }
+}
+
+// Advances every UE by one TTI and refreshes sinr_db, cqi and mcs
+static inline void channel_model_step(ChannelModel *channel) {
+    int n = channel->num_ues;
+    float *restrict pos_x = channel->pos_x;
+    float *restrict pos_y = channel->pos_y;
+    float *restrict vel_x = channel->vel_x;
+    float *restrict vel_y = channel->vel_y;
+    float *restrict shadowing = channel->shadowing_db;
+    const float *restrict shadowing_rho = channel->shadowing_rho;
+    const float *restrict shadowing_innov = channel->shadowing_innov;
+    float *restrict fading_re = channel->fading_re;
+    float *restrict fading_im = channel->fading_im;
+    const float *restrict fading_rho = channel->fading_rho;
+    const float *restrict fading_innov = channel->fading_innov;
+    uint32_t *restrict rng = channel->rng;
+    uint32_t *restrict fading_rng = channel->fading_rng;
+    float *restrict sinr_db = channel->sinr_db;
+    uint8_t *restrict cqi = channel->cqi;
+    uint8_t *restrict mcs = channel->mcs;
+
+    for (int i = 0; i < n; i++) {
+        // Move, bouncing back at the cell edge
+        float x = pos_x[i] + vel_x[i] * CHANNEL_TTI_S;
+        float y = pos_y[i] + vel_y[i] * CHANNEL_TTI_S;
+        float d2 = x * x + y * y;
+        int outside = d2 > CHANNEL_CELL_RADIUS_M * CHANNEL_CELL_RADIUS_M;
+        vel_x[i] = outside ? -vel_x[i] : vel_x[i];
+        vel_y[i] = outside ? -vel_y[i] : vel_y[i];
+        pos_x[i] = x;
+        pos_y[i] = y;
+
+        float distance = fmaxf(sqrtf(d2), CHANNEL_MIN_DISTANCE_M);
+        float pathloss_db = 128.1f + 16.329f * logf(distance * 0.001f);
+
+        uint32_t state = rng[i];
+        float g0 = channel_rng_gaussian(&state);
+        uint32_t fading_state = fading_rng != NULL ? fading_rng[i] : state;
+        float g1 = channel_rng_gaussian(&fading_state);
+        float g2 = channel_rng_gaussian(&fading_state);
+        if (fading_rng != NULL) {
+            rng[i] = state;
+            fading_rng[i] = fading_state;
+        } else {
+            rng[i] = fading_state;
+        }
+
+        float s = shadowing_rho[i] * shadowing[i] + shadowing_innov[i] * g0;
+        float re = fading_rho[i] * fading_re[i] + fading_innov[i] * g1;
+        float im = fading_rho[i] * fading_im[i] + fading_innov[i] * g2;
+        shadowing[i] = s;
+        fading_re[i] = re;
+        fading_im[i] = im;
+
+        float gain = re * re + im * im + 1e-12f;
+        float sinr = CHANNEL_TX_POWER_DBM - pathloss_db - s + 4.3429448f * logf(gain) - CHANNEL_NOISE_INTERFERENCE_DBM;
+        sinr_db[i] = sinr;
+
+        int q = 0;
+        for (int k = 0; k < CQI_COUNT - 1; k++) {
+            q += sinr >= cqi_sinr_threshold_db[k];
+        }
+        cqi[i] = (uint8_t)q;
+        mcs[i] = (uint8_t)cqi_to_mcs[q];
+    }
+}
+
+// Runs num_ttis steps and stores the MCS of every UE, TTI-major, into out
+static inline void channel_model_generate(ChannelModel *channel, int num_ttis, uint8_t *out) {
+    for (int t = 0; t < num_ttis; t++) {
+        channel_model_step(channel);
+        memcpy(out + (size_t)t * channel->num_ues, channel->mcs, channel->num_ues);
+    }
+}
+
+// Opens a trace for a run of num_ues UEs over num_ttis TTIs; it must cover exactly those UEs
+// and at least that many TTIs
+static inline FILE *channel_trace_open(const char *path, int num_ues, int num_ttis, ChannelTraceHeader *header) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Failed to open channel trace");
+        exit(EXIT_FAILURE);
+    }
+    if (fread(header, sizeof(*header), 1, file) != 1 || memcmp(header->magic, CHANNEL_TRACE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s is not a channel trace\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (header->num_ues != (uint32_t)num_ues || header->num_ttis < (uint32_t)num_ttis) {
+        fprintf(stderr, "%s has %u UEs x %u TTIs, the run needs %d UEs x %d TTIs\n", path, header->num_ues,
+                header->num_ttis, num_ues, num_ttis);
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+// Reads the MCS of every UE for the next TTI; returns 0 at the end of the trace
+static inline int channel_trace_read_tti(FILE *file, const ChannelTraceHeader *header, uint8_t *mcs) {
+    return fread(mcs, 1, header->num_ues, file) == header->num_ues;
+}
+
+#endif
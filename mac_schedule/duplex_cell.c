@@ -0,0 +1,139 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scenario.h"
+#include "channel_model.h"
+#include "scheduler_policy.h"
+#include "uplink.h"
+
+// Full-duplex cell: every TTI runs the downlink PF scheduler (full buffer) and the uplink
+// BSR/PHR scheduler from uplink.h on the same UEs and channel, and times both directions.
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+#define PF_AVERAGING_TTIS 100.0f
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+double now_ns();
+int downlink_schedule(const ChannelModel *channel, float *average_rate, int *selected, float *keys, long long *bytes);
+
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
+    generate_TBSArray(TBSArray);
+    unsigned int seed = scenario_seed(&scenario);
+    int num_users = scenario.users;
+    int total_ttis = scenario.ttis;
+
+    printf("THIS IS FULL-DUPLEX CELL SIMULATION (%d UEs, %d RBs per direction, %d grants per direction per TTI)\n",
+           num_users, scenario.resource_blocks, scenario.users_per_tti);
+    printf("Uplink: %.0f kbps per UE, BSR every %d TTIs, PHR every %d TTIs\n", scenario.ul_kbps,
+           scenario.bsr_period_ttis, scenario.phr_period_ttis);
+
+    ChannelModel channel;
+    UplinkState ul;
+    channel_model_init(&channel, num_users, seed);
+    uplink_init(&ul, num_users, scenario.resource_blocks, scenario.users_per_tti, scenario.ul_kbps, seed);
+
+    float *average_rate = malloc(num_users * sizeof(float));
+    int *selected = malloc(scenario.users_per_tti * sizeof(int));
+    float *keys = malloc(scenario.users_per_tti * sizeof(float));
+    for (int i = 0; i < num_users; i++) {
+        average_rate[i] = 1.0f;
+    }
+
+    long long dl_bytes = 0;
+    long long buffered = 0;
+    double channel_ns = 0, dl_ns = 0, ul_ns = 0;
+    for (int tti = 0; tti < total_ttis; tti++) {
+        double start = now_ns();
+        channel_model_step(&channel);
+        double dl_start = now_ns();
+        downlink_schedule(&channel, average_rate, selected, keys, &dl_bytes);
+        double ul_start = now_ns();
+        uplink_step(&ul, &channel);
+        uplink_reports(&ul, tti, scenario.bsr_period_ttis, scenario.phr_period_ttis);
+        uplink_schedule(&ul, tti, scenario.users_per_tti, TBSArray);
+        uplink_transmit(&ul);
+        double end = now_ns();
+        channel_ns += dl_start - start;
+        dl_ns += ul_start - dl_start;
+        ul_ns += end - ul_start;
+
+        for (int i = 0; i < num_users; i++) {
+            buffered += ul.buffer[i];
+        }
+    }
+
+    double seconds = total_ttis * TTI_DURATION;
+    printf("\nDownlink throughput = %.3f Mbps\n", dl_bytes * 8 / 1000000.0 / seconds);
+    printf("Uplink throughput = %.3f Mbps (offered %.3f Mbps), padding = %.1f%%\n", ul.bytes_sent * 8 / 1000000.0 / seconds,
+           num_users * scenario.ul_kbps / 1000.0,
+           ul.bytes_sent + ul.bytes_padding > 0 ? 100.0 * ul.bytes_padding / (ul.bytes_sent + ul.bytes_padding) : 0);
+    printf("Uplink grants per TTI = %.2f, RB use = %.1f%%, power-limited grants = %.1f%%\n",
+           (double)ul.total_grants / total_ttis, 100.0 * ul.blocks_granted / ((double)total_ttis * scenario.resource_blocks),
+           ul.total_grants > 0 ? 100.0 * ul.power_limited_grants / ul.total_grants : 0);
+    printf("Average uplink buffer = %.0f bytes per UE\n", (double)buffered / total_ttis / num_users);
+    printf("\nTime per TTI: channel %.0f ns, downlink %.0f ns, uplink %.0f ns, total %.0f ns\n", channel_ns / total_ttis,
+           dl_ns / total_ttis, ul_ns / total_ttis, (channel_ns + dl_ns + ul_ns) / total_ttis);
+
+    free(average_rate);
+    free(selected);
+    free(keys);
+    uplink_free(&ul);
+    channel_model_free(&channel);
+    return 0;
+}
+
+double now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Full-buffer PF: the users_per_tti best rate/average UEs split the RBs
+int downlink_schedule(const ChannelModel *channel, float *average_rate, int *selected, float *keys, long long *bytes) {
+    int num_users = scenario.users;
+    int count = scenario.users_per_tti;
+    int per_user = scenario.resource_blocks / count;
+    int extra = scenario.resource_blocks % count;
+    const uint8_t *mcs = channel->mcs;
+
+    int found = 0;
+    for (int i = 0; i < num_users; i++) {
+        float key = TBSArray[mcs[i]][per_user > 0 ? per_user : 1] / average_rate[i];
+        scheduler_top_k_float(key, i, count, &found, keys, selected);
+    }
+
+    for (int i = 0; i < num_users; i++) {
+        average_rate[i] *= 1.0f - 1.0f / PF_AVERAGING_TTIS;
+    }
+    for (int s = 0; s < found; s++) {
+        int blocks = per_user + (s < extra);
+        if (blocks == 0) {
+            break;
+        }
+        int tbs = TBSArray[mcs[selected[s]]][blocks];
+        *bytes += tbs;
+        average_rate[selected[s]] += tbs / PF_AVERAGING_TTIS;
+    }
+    return found;
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
@@ -0,0 +1,396 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "event_calendar.h"
+#include "fairness_stats.h"
+#include "scenario.h"
+#include "scheduler_policy.h"
+#include "score_pool.h"
+#include "tti_log.h"
+#include "ue_pool.h"
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+#define INITIAL_POOL_SIZE 64
+#define EVENT_CALENDAR_TTIS 4096
+#define ARRIVAL_EVENT -1
+
+typedef struct {
+    long long sessions;
+    long long bytes;
+    double session_throughput_sum;
+    long long times_scheduled;
+} SessionStats;
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+int rr_cursor = 0;
+Scenario scenario;
+// Per-TTI selection scratch, sized from the scenario once at startup
+int *selected_slots;
+long long *selected_keys;
+long long *candidate_keys;
+int candidate_keys_capacity = 0;
+// Slots whose departure came due this TTI, grown with the pool
+int *departed_slots;
+int departed_slots_capacity = 0;
+// Ranking is split across score_pool from parallel_threshold active UEs; INT_MAX keeps it serial
+ScorePool score_pool;
+int parallel_threshold = INT_MAX;
+TtiLog *tti_log = NULL;
+int current_cell = 0;
+// Next session arrival and every departure before the end of the run, by TTI. While no session
+// is active the loop jumps straight to the next event; `--dense` visits every TTI instead
+EventCalendar events;
+int pending_arrivals = 0;
+int dense_loop = 0;
+// Fairness of the current cell, and of the whole run
+FairnessStats cell_fairness;
+FairnessStats run_fairness;
+ActiveFairness active_fairness;
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+void schedule_next_arrival(int after_tti);
+double run_cell(UEPool *pool, const SchedulerPolicy *policy, unsigned int seed, int cell);
+int session_length(double mean_ttis);
+void admit_sessions(UEPool *pool, int count, int current_tti, int *next_user_id);
+void record_session(UEPool *pool, int slot, int current_tti, SessionStats *stats);
+void release_departed(UEPool *pool, int num_departed, int current_tti, SessionStats *stats);
+int select_users(UEPool *pool, const SchedulerPolicy *policy, int current_tti, int selected[]);
+void assign_resource_blocks(UEPool *pool, int slot, int num_blocks, int current_tti);
+void dynamic_scheduler(UEPool *pool, const SchedulerPolicy *policy, int total_resource_blocks, int current_tti);
+
+int main(int argc, char *argv[]) {
+    const char *scenario_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dense") == 0) {
+            dense_loop = 1;
+        } else {
+            scenario_path = argv[i];
+        }
+    }
+    load_scenario(scenario_path, &scenario);
+
+    const SchedulerPolicy *policy = find_scheduler_policy(scenario.policy);
+    if (policy == NULL) {
+        fprintf(stderr, "Unknown policy '%s'\n", scenario.policy);
+        return 1;
+    }
+
+    generate_TBSArray(TBSArray);
+    if (scenario.workers > 1 && policy->ranks) {
+        score_pool_init(&score_pool, scenario.workers, scenario.users_per_tti);
+        parallel_threshold = scenario.parallel_threshold;
+        if (parallel_threshold == 0) {
+            printf("Measuring serial and parallel ranking with %d threads:\n", scenario.workers);
+            parallel_threshold = score_pool_crossover(&score_pool, policy, scenario.users_per_tti, stdout);
+            if (parallel_threshold < 0) {
+                printf("No crossover up to 500000 UEs, ranking stays serial\n");
+                parallel_threshold = INT_MAX;
+            } else {
+                printf("Crossover at %d active UEs\n", parallel_threshold);
+            }
+        }
+    }
+    selected_slots = malloc(scenario.users_per_tti * sizeof(int));
+    selected_keys = malloc(scenario.users_per_tti * sizeof(long long));
+
+    // Size the pool for the initial population plus twice the expected concurrent sessions
+    UEPool pool;
+    int expected_sessions = (int)(2 * scenario.arrival_rate * scenario.mean_session_ttis);
+    ue_pool_init(&pool, scenario.users + (expected_sessions > INITIAL_POOL_SIZE ? expected_sessions : INITIAL_POOL_SIZE));
+    event_calendar_init(&events, EVENT_CALENDAR_TTIS, pool.capacity + 1);
+
+    if (scenario.tti_log[0] != '\0') {
+        tti_log = tti_log_open(scenario.tti_log);
+    }
+
+    unsigned int seed = scenario_seed(&scenario);
+    double cell_throughput_sum = 0;
+
+    printf("THIS IS DYNAMIC USERS SIMULATION (%s)\n", scenario.policy);
+
+    for (int cell = 0; cell < scenario.cells; cell++) {
+        cell_throughput_sum += run_cell(&pool, policy, seed + cell, cell);
+    }
+
+    if (scenario.cells > 1) {
+        printf("\nAverage throughput over %d cells = %.3f Mbps\n", scenario.cells, cell_throughput_sum / scenario.cells);
+        fairness_print(&run_fairness, stdout);
+    }
+    if (scenario.stats_file[0] != '\0') {
+        fairness_write(&run_fairness, scenario.stats_file);
+    }
+
+    int status = 0;
+    if (tti_log != NULL) {
+        long long rows = tti_log->rows_written;
+        int chunks = tti_log->chunks_allocated;
+        if (tti_log_close(tti_log)) {
+            printf("TTI log: %lld rows written to %s (%d chunk buffers)\n", rows, scenario.tti_log, chunks);
+        } else {
+            printf("TTI log: FAILED, %s is incomplete (%lld rows logged)\n", scenario.tti_log, rows);
+            status = 1;
+        }
+    }
+
+    ue_pool_free(&pool);
+    event_calendar_free(&events);
+    free(selected_slots);
+    free(selected_keys);
+    free(candidate_keys);
+    free(departed_slots);
+    if (scenario.workers > 1 && policy->ranks) {
+        score_pool_free(&score_pool);
+    }
+    return status;
+}
+
+double run_cell(UEPool *pool, const SchedulerPolicy *policy, unsigned int seed, int cell) {
+    int total_ttis = scenario.ttis;
+    SessionStats stats = {0};
+    int next_user_id = 0;
+    long long active_sum = 0;
+    int peak_active = 0;
+    long long ttis_visited = 0;
+
+    srand(seed);
+    rr_cursor = 0;
+    current_cell = cell;
+    memset(&cell_fairness, 0, sizeof(cell_fairness));
+    active_fairness = (ActiveFairness){0};
+    event_calendar_clear(&events);
+    admit_sessions(pool, scenario.users, 0, &next_user_id);
+    schedule_next_arrival(-1);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int tti = 0;
+    while (tti < total_ttis) {
+        int item, departures = 0, arrivals = 0;
+        while (event_calendar_pop(&events, tti, &item)) {
+            if (item == ARRIVAL_EVENT) {
+                arrivals = pending_arrivals;
+            } else {
+                if (departures == departed_slots_capacity) {
+                    departed_slots_capacity = pool->capacity;
+                    departed_slots = realloc(departed_slots, departed_slots_capacity * sizeof(int));
+                }
+                departed_slots[departures++] = item;
+            }
+        }
+        if (departures > 0) {
+            release_departed(pool, departures, tti, &stats);
+        }
+        if (arrivals > 0) {
+            admit_sessions(pool, arrivals, tti, &next_user_id);
+            schedule_next_arrival(tti);
+        }
+        dynamic_scheduler(pool, policy, scenario.resource_blocks, tti);
+        fairness_tti(&cell_fairness, &active_fairness);
+
+        active_sum += pool->num_active;
+        if (pool->num_active > peak_active) {
+            peak_active = pool->num_active;
+        }
+        ttis_visited++;
+        tti++;
+
+        // An empty cell stays empty, and an empty TTI changes nothing, until the next arrival
+        if (pool->num_active == 0 && !dense_loop) {
+            int next = event_calendar_next(&events, tti);
+            tti = next < total_ttis ? next : total_ttis;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Sessions still running at the end count with their partial duration
+    long long completed = stats.sessions;
+    while (pool->num_active > 0) {
+        record_session(pool, pool->active[pool->num_active - 1], total_ttis, &stats);
+        ue_pool_release(pool, pool->active[pool->num_active - 1]);
+    }
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double cell_throughput = (stats.bytes * 8 / 1000000.0) / (total_ttis * TTI_DURATION);
+    printf("\nCell %d: sessions arrived = %d, completed = %lld, peak active = %d, average active = %.2f, pool capacity = %d\n",
+           cell, next_user_id, completed, peak_active, (double)active_sum / total_ttis, pool->capacity);
+    if (stats.sessions > 0) {
+        printf("Average session throughput = %.3f Mbps, Average times scheduled per session = %.2f\n",
+               stats.session_throughput_sum / stats.sessions, (double)stats.times_scheduled / stats.sessions);
+    }
+    printf("Average throughput over the entire cell = %.3f Mbps\n", cell_throughput);
+    fairness_print(&cell_fairness, stdout);
+    printf("Simulated %d TTIs in %.3f s (%.1f ns per TTI, %lld TTIs visited)\n", total_ttis, elapsed,
+           elapsed * 1e9 / total_ttis, ttis_visited);
+    fairness_merge(&run_fairness, &cell_fairness);
+
+    return cell_throughput;
+}
+
+// Poisson(arrival_rate) sessions per TTI, drawn one busy TTI at a time: the gap to the next
+// TTI with any arrival is geometric and the count there a zero-truncated Poisson. Both loops
+// draw the same numbers, so skipping idle TTIs cannot change the results.
+void schedule_next_arrival(int after_tti) {
+    double rate = scenario.arrival_rate;
+    if (rate <= 0) {
+        return;
+    }
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 1.0);
+    double gap = 1 + floor(-log(u) / rate);
+    if (after_tti + gap >= scenario.ttis) {
+        return;
+    }
+
+    // Inversion over P(k) = e^-rate rate^k / k! / (1 - e^-rate), k >= 1
+    double v = (double)rand() / RAND_MAX;
+    double probability = rate * exp(-rate) / -expm1(-rate);
+    double cumulative = probability;
+    int count = 1;
+    while (v > cumulative && probability > 0) {
+        count++;
+        probability *= rate / count;
+        cumulative += probability;
+    }
+    pending_arrivals = count;
+    event_calendar_schedule(&events, after_tti + (int)gap, ARRIVAL_EVENT);
+}
+
+int session_length(double mean_ttis) {
+    if (mean_ttis == 0) {
+        return INT_MAX / 2;
+    }
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 1.0);
+    return 1 + (int)(-mean_ttis * log(u));
+}
+
+void admit_sessions(UEPool *pool, int count, int current_tti, int *next_user_id) {
+    for (int i = 0; i < count; i++) {
+        int slot = ue_pool_alloc(pool);
+        pool->user_id[slot] = (*next_user_id)++;
+        pool->mcs_index[slot] = rand() % (MAX_MCS_INDEX + 1);
+        pool->arrival_tti[slot] = current_tti;
+        pool->departure_tti[slot] = current_tti + session_length(scenario.mean_session_ttis);
+        if (pool->departure_tti[slot] < scenario.ttis) {
+            event_calendar_schedule(&events, pool->departure_tti[slot], slot);
+        }
+        active_fairness_arrive(&active_fairness);
+    }
+}
+
+void record_session(UEPool *pool, int slot, int current_tti, SessionStats *stats) {
+    int duration = current_tti - pool->arrival_tti[slot];
+    stats->sessions++;
+    stats->bytes += pool->total_data_transmitted[slot];
+    stats->times_scheduled += pool->times_scheduled[slot];
+    if (duration > 0) {
+        double throughput = (pool->total_data_transmitted[slot] * 8 / 1000000.0) / (duration * TTI_DURATION);
+        stats->session_throughput_sum += throughput;
+        fairness_session(&cell_fairness, throughput);
+    }
+
+    // The wait since the last grant (or arrival) counts as a gap too, so starved UEs show up
+    int last = pool->last_scheduled_tti[slot] >= 0 ? pool->last_scheduled_tti[slot] : pool->arrival_tti[slot];
+    if (current_tti > last) {
+        fairness_gap(&cell_fairness, current_tti - last);
+    }
+    active_fairness_depart(&active_fairness, pool->total_data_transmitted[slot]);
+}
+
+// Releases the num_departed slots in departed_slots[]. Going from the back of the active list
+// forward, each swap-remove only moves a UE that stays, so the active order (and with it
+// round robin and the tie-breaks) is the one a backwards walk over all UEs would leave.
+void release_departed(UEPool *pool, int num_departed, int current_tti, SessionStats *stats) {
+    for (int i = 1; i < num_departed; i++) {
+        int slot = departed_slots[i];
+        int j = i;
+        while (j > 0 && pool->active_pos[departed_slots[j - 1]] < pool->active_pos[slot]) {
+            departed_slots[j] = departed_slots[j - 1];
+            j--;
+        }
+        departed_slots[j] = slot;
+    }
+    for (int i = 0; i < num_departed; i++) {
+        record_session(pool, departed_slots[i], current_tti, stats);
+        ue_pool_release(pool, departed_slots[i]);
+    }
+}
+
+// Fills selected[] with up to users_per_tti live slots in priority order and returns how many
+int select_users(UEPool *pool, const SchedulerPolicy *policy, int current_tti, int selected[]) {
+    if (pool->num_active > candidate_keys_capacity) {
+        candidate_keys_capacity = pool->capacity;
+        candidate_keys = realloc(candidate_keys, candidate_keys_capacity * sizeof(long long));
+    }
+
+    SchedulerInput in;
+    in.num_candidates = pool->num_active;
+    in.candidate_base = 0;
+    in.candidates = pool->active;
+    in.mcs_index = pool->mcs_index;
+    in.last_scheduled_tti = pool->last_scheduled_tti;
+    in.current_tti = current_tti;
+    in.scheduling_interval = scenario.scheduling_interval;
+    in.rr_cursor = &rr_cursor;
+    in.keys = candidate_keys;
+    in.best = selected_keys;
+    if (pool->num_active >= parallel_threshold) {
+        return score_pool_select(&score_pool, policy, &in, scenario.users_per_tti, selected);
+    }
+    return policy->select(&in, scenario.users_per_tti, selected);
+}
+
+void assign_resource_blocks(UEPool *pool, int slot, int num_blocks, int current_tti) {
+    int last = pool->last_scheduled_tti[slot];
+    if (last != current_tti) {
+        fairness_gap(&cell_fairness, current_tti - (last >= 0 ? last : pool->arrival_tti[slot]));
+    }
+    int bytes = TBSArray[pool->mcs_index[slot]][num_blocks];
+    active_fairness_serve(&active_fairness, pool->total_data_transmitted[slot], bytes);
+
+    pool->total_resource_blocks[slot] += num_blocks;
+    pool->times_scheduled[slot] += 1;
+    pool->total_data_transmitted[slot] += bytes;
+    pool->last_scheduled_tti[slot] = current_tti;
+
+    if (tti_log != NULL) {
+        tti_log_append(tti_log, current_cell, current_tti, pool->user_id[slot], num_blocks,
+                       pool->mcs_index[slot], TBSArray[pool->mcs_index[slot]][num_blocks]);
+    }
+}
+
+void dynamic_scheduler(UEPool *pool, const SchedulerPolicy *policy, int total_resource_blocks, int current_tti) {
+    int count = select_users(pool, policy, current_tti, selected_slots);
+    int *selected = selected_slots;
+    if (count == 0) {
+        return;
+    }
+
+    int blocks_per_user = total_resource_blocks / count;
+    int remaining_blocks = total_resource_blocks % count;
+
+    for (int i = 0; i < count; i++) {
+        assign_resource_blocks(pool, selected[i], blocks_per_user, current_tti);
+    }
+    for (int i = 0; i < remaining_blocks; i++) {
+        assign_resource_blocks(pool, selected[i], 1, current_tti);
+    }
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
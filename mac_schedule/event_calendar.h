@@ -0,0 +1,149 @@
+#ifndef EVENT_CALENDAR_H
+#define EVENT_CALENDAR_H
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Calendar queue of future events keyed by TTI: one bucket per TTI modulo the number of
+// buckets, each an unsorted intrusive list. Scheduling and popping the events of a TTI cost
+// O(1) plus the events sharing the bucket from later laps. Finding the next TTI with an event
+// walks at most one lap of buckets and then falls back to a scan of all pending events, which
+// only happens after an idle stretch longer than the calendar.
+//
+// Events live in a pool that grows by doubling; freed events are reused, so steady-state
+// scheduling does no heap work.
+
+typedef struct {
+    int num_buckets;    // power of two
+    int *head;          // per bucket: first event, -1 when empty
+    int capacity;
+    int count;
+    int free_head;
+    int *event_tti;
+    int *event_item;
+    int *event_next;    // bucket or free-list link
+} EventCalendar;
+
+static inline void *event_calendar_resize(void *ptr, int capacity, size_t size) {
+    void *resized = realloc(ptr, (size_t)capacity * size);
+    if (resized == NULL) {
+        perror("Failed to grow event calendar");
+        exit(EXIT_FAILURE);
+    }
+    return resized;
+}
+
+static inline void event_calendar_grow(EventCalendar *calendar, int capacity) {
+    calendar->event_tti = event_calendar_resize(calendar->event_tti, capacity, sizeof(int));
+    calendar->event_item = event_calendar_resize(calendar->event_item, capacity, sizeof(int));
+    calendar->event_next = event_calendar_resize(calendar->event_next, capacity, sizeof(int));
+    for (int e = capacity - 1; e >= calendar->capacity; e--) {
+        calendar->event_next[e] = calendar->free_head;
+        calendar->free_head = e;
+    }
+    calendar->capacity = capacity;
+}
+
+static inline void event_calendar_init(EventCalendar *calendar, int num_buckets, int capacity) {
+    int buckets = 1;
+    while (buckets < num_buckets) {
+        buckets <<= 1;
+    }
+    calendar->num_buckets = buckets;
+    calendar->head = malloc(buckets * sizeof(int));
+    if (calendar->head == NULL) {
+        perror("Failed to allocate event calendar");
+        exit(EXIT_FAILURE);
+    }
+    for (int b = 0; b < buckets; b++) {
+        calendar->head[b] = -1;
+    }
+    calendar->capacity = 0;
+    calendar->count = 0;
+    calendar->free_head = -1;
+    calendar->event_tti = NULL;
+    calendar->event_item = NULL;
+    calendar->event_next = NULL;
+    event_calendar_grow(calendar, capacity > 0 ? capacity : 1);
+}
+
+static inline void event_calendar_free(EventCalendar *calendar) {
+    free(calendar->head);
+    free(calendar->event_tti);
+    free(calendar->event_item);
+    free(calendar->event_next);
+}
+
+// Drops every pending event
+static inline void event_calendar_clear(EventCalendar *calendar) {
+    for (int b = 0; b < calendar->num_buckets; b++) {
+        int e = calendar->head[b];
+        while (e >= 0) {
+            int next = calendar->event_next[e];
+            calendar->event_next[e] = calendar->free_head;
+            calendar->free_head = e;
+            e = next;
+        }
+        calendar->head[b] = -1;
+    }
+    calendar->count = 0;
+}
+
+static inline void event_calendar_schedule(EventCalendar *calendar, int tti, int item) {
+    if (calendar->free_head < 0) {
+        event_calendar_grow(calendar, calendar->capacity * 2);
+    }
+    int e = calendar->free_head;
+    calendar->free_head = calendar->event_next[e];
+    int bucket = tti & (calendar->num_buckets - 1);
+    calendar->event_tti[e] = tti;
+    calendar->event_item[e] = item;
+    calendar->event_next[e] = calendar->head[bucket];
+    calendar->head[bucket] = e;
+    calendar->count++;
+}
+
+// Removes one event due at tti and stores its item; returns 0 when there is none
+static inline int event_calendar_pop(EventCalendar *calendar, int tti, int *item) {
+    int *link = &calendar->head[tti & (calendar->num_buckets - 1)];
+    while (*link >= 0) {
+        int e = *link;
+        if (calendar->event_tti[e] == tti) {
+            *item = calendar->event_item[e];
+            *link = calendar->event_next[e];
+            calendar->event_next[e] = calendar->free_head;
+            calendar->free_head = e;
+            calendar->count--;
+            return 1;
+        }
+        link = &calendar->event_next[e];
+    }
+    return 0;
+}
+
+// Earliest TTI >= from with an event, INT_MAX when the calendar is empty
+static inline int event_calendar_next(const EventCalendar *calendar, int from) {
+    if (calendar->count == 0) {
+        return INT_MAX;
+    }
+    int mask = calendar->num_buckets - 1;
+    for (int tti = from; tti < from + calendar->num_buckets; tti++) {
+        for (int e = calendar->head[tti & mask]; e >= 0; e = calendar->event_next[e]) {
+            if (calendar->event_tti[e] == tti) {
+                return tti;
+            }
+        }
+    }
+    int earliest = INT_MAX;
+    for (int b = 0; b < calendar->num_buckets; b++) {
+        for (int e = calendar->head[b]; e >= 0; e = calendar->event_next[e]) {
+            if (calendar->event_tti[e] >= from && calendar->event_tti[e] < earliest) {
+                earliest = calendar->event_tti[e];
+            }
+        }
+    }
+    return earliest;
+}
+
+#endif
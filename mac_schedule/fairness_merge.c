@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fairness_stats.h"
+
+// Merges the fairness stats files of several runs (e.g. sweep workers, each with its own
+// stats_file) and prints the combined report
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <stats_file> [stats_file ...]\n", argv[0]);
+        return 1;
+    }
+
+    FairnessStats *total = calloc(1, sizeof(FairnessStats));
+    FairnessStats *run = malloc(sizeof(FairnessStats));
+    for (int i = 1; i < argc; i++) {
+        if (!fairness_read(run, argv[i])) {
+            fprintf(stderr, "%s is not a version %d fairness stats file\n", argv[i], FAIRNESS_VERSION);
+            return 1;
+        }
+        fairness_merge(total, run);
+    }
+
+    printf("%d runs, %lld sessions\n", argc - 1, total->sessions);
+    fairness_print(total, stdout);
+    free(run);
+    free(total);
+    return 0;
+}
@@ -0,0 +1,222 @@
+#ifndef FAIRNESS_STATS_H
+#define FAIRNESS_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Online fairness and distribution statistics, updated as the simulation runs so no per-TTI
+// or per-UE data has to be kept:
+//   - Jain's index over the active UEs' bytes served so far, sampled every TTI with active
+//     UEs (O(1): the sums are updated per grant, arrival and departure) and averaged
+//   - Jain's index over per-session throughput
+//   - per-session throughput distribution (5th percentile "cell edge", median, ...)
+//   - scheduling gap distribution: TTIs between a UE's grants, from arrival to its first
+//     grant, and from its last grant to departure (so a UE never served still counts)
+//
+// Distributions go into HDR-style log-linear histograms: values below 128 are exact, larger
+// ones fall in 64 buckets per power of two (within 1.6%). The layout is fixed, so two
+// histograms, and two FairnessStats, merge exactly by adding them up: cells of one run, or
+// sweep workers through their stats files (fairness_merge).
+
+#define HDR_SUB_BITS 6
+#define HDR_SUB_BUCKETS (1 << HDR_SUB_BITS)
+#define HDR_BUCKETS (HDR_SUB_BUCKETS * 58)     // up to 2^62
+#define FAIRNESS_MAGIC "FAIR"
+#define FAIRNESS_VERSION 1
+
+typedef struct {
+    long long count;
+    long long min;
+    long long max;
+    double sum;
+    long long counts[HDR_BUCKETS];
+} HdrHistogram;
+
+typedef struct {
+    long long ttis;                 // TTIs with active UEs that had been served
+    double active_jain_sum;
+    long long sessions;
+    double throughput_sum;          // per-session Mbps, and its squares, for Jain's index
+    double throughput_squares;
+    HdrHistogram throughput_kbps;   // per session
+    HdrHistogram gap_ttis;
+} FairnessStats;
+
+// Running sums over the active UEs' bytes served, for Jain's index of the current TTI
+typedef struct {
+    long long users;
+    double sum;
+    double squares;
+} ActiveFairness;
+
+static inline int hdr_index(long long value) {
+    if (value < 0) {
+        value = 0;
+    }
+    int shift = 63 - __builtin_clzll((unsigned long long)value | 1) - HDR_SUB_BITS;
+    if (shift < 0) {
+        shift = 0;
+    }
+    return shift * HDR_SUB_BUCKETS + (int)(value >> shift);
+}
+
+// Middle of the bucket's range
+static inline long long hdr_value(int index) {
+    if (index < 2 * HDR_SUB_BUCKETS) {
+        return index;
+    }
+    int shift = index / HDR_SUB_BUCKETS - 1;
+    long long low = (long long)(index - shift * HDR_SUB_BUCKETS) << shift;
+    return low + (1LL << (shift - 1));
+}
+
+static inline void hdr_record(HdrHistogram *histogram, long long value) {
+    if (histogram->count == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if (histogram->count == 0 || value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->count++;
+    histogram->sum += value;
+    histogram->counts[hdr_index(value)]++;
+}
+
+static inline void hdr_merge(HdrHistogram *into, const HdrHistogram *from) {
+    if (from->count == 0) {
+        return;
+    }
+    if (into->count == 0 || from->min < into->min) {
+        into->min = from->min;
+    }
+    if (into->count == 0 || from->max > into->max) {
+        into->max = from->max;
+    }
+    into->count += from->count;
+    into->sum += from->sum;
+    for (int i = 0; i < HDR_BUCKETS; i++) {
+        into->counts[i] += from->counts[i];
+    }
+}
+
+// Smallest recorded value with at least fraction of the values at or below it, clamped to
+// the exact min and max
+static inline long long hdr_quantile(const HdrHistogram *histogram, double fraction) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    long long rank = (long long)(fraction * histogram->count + 0.999999);
+    rank = rank < 1 ? 1 : rank;
+    long long seen = 0;
+    for (int i = 0; i < HDR_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            long long value = hdr_value(i);
+            value = value < histogram->min ? histogram->min : value;
+            return value > histogram->max ? histogram->max : value;
+        }
+    }
+    return histogram->max;
+}
+
+static inline double hdr_mean(const HdrHistogram *histogram) {
+    return histogram->count > 0 ? histogram->sum / histogram->count : 0;
+}
+
+static inline void active_fairness_arrive(ActiveFairness *active) {
+    active->users++;
+}
+
+// A UE that had been served bytes so far got delta more
+static inline void active_fairness_serve(ActiveFairness *active, long long bytes, long long delta) {
+    active->sum += delta;
+    active->squares += (2.0 * bytes + delta) * delta;
+}
+
+static inline void active_fairness_depart(ActiveFairness *active, long long bytes) {
+    active->users--;
+    active->sum -= bytes;
+    active->squares -= (double)bytes * bytes;
+    if (active->users == 0) {
+        active->sum = active->squares = 0;     // drop accumulated rounding
+    }
+}
+
+static inline void fairness_tti(FairnessStats *stats, const ActiveFairness *active) {
+    if (active->users > 0 && active->squares > 0) {
+        stats->ttis++;
+        stats->active_jain_sum += active->sum * active->sum / (active->users * active->squares);
+    }
+}
+
+static inline void fairness_session(FairnessStats *stats, double throughput_mbps) {
+    stats->sessions++;
+    stats->throughput_sum += throughput_mbps;
+    stats->throughput_squares += throughput_mbps * throughput_mbps;
+    hdr_record(&stats->throughput_kbps, (long long)(throughput_mbps * 1000 + 0.5));
+}
+
+static inline void fairness_gap(FairnessStats *stats, int ttis) {
+    hdr_record(&stats->gap_ttis, ttis);
+}
+
+static inline void fairness_merge(FairnessStats *into, const FairnessStats *from) {
+    into->ttis += from->ttis;
+    into->active_jain_sum += from->active_jain_sum;
+    into->sessions += from->sessions;
+    into->throughput_sum += from->throughput_sum;
+    into->throughput_squares += from->throughput_squares;
+    hdr_merge(&into->throughput_kbps, &from->throughput_kbps);
+    hdr_merge(&into->gap_ttis, &from->gap_ttis);
+}
+
+static inline void fairness_print(const FairnessStats *stats, FILE *out) {
+    double session_jain = stats->throughput_squares > 0
+                              ? stats->throughput_sum * stats->throughput_sum / (stats->sessions * stats->throughput_squares)
+                              : 0;
+    fprintf(out, "Jain's fairness index: %.4f over sessions, %.4f over active UEs (average of %lld TTIs)\n", session_jain,
+            stats->ttis > 0 ? stats->active_jain_sum / stats->ttis : 0, stats->ttis);
+    const HdrHistogram *throughput = &stats->throughput_kbps;
+    fprintf(out, "Session throughput: 5th percentile (cell edge) = %.3f Mbps, median = %.3f Mbps, 95th = %.3f Mbps, "
+                 "max = %.3f Mbps\n",
+            hdr_quantile(throughput, 0.05) / 1000.0, hdr_quantile(throughput, 0.5) / 1000.0,
+            hdr_quantile(throughput, 0.95) / 1000.0, throughput->max / 1000.0);
+    const HdrHistogram *gaps = &stats->gap_ttis;
+    fprintf(out, "Scheduling gaps: %lld, mean = %.2f TTIs, median = %lld, 95th = %lld, 99th = %lld, 99.9th = %lld, "
+                 "max = %lld TTIs\n",
+            gaps->count, hdr_mean(gaps), hdr_quantile(gaps, 0.5), hdr_quantile(gaps, 0.95), hdr_quantile(gaps, 0.99),
+            hdr_quantile(gaps, 0.999), gaps->max);
+}
+
+// Stats files hold "FAIR", uint32 version, then the FairnessStats as laid out in memory, so
+// they merge on machines of the same architecture
+static inline void fairness_write(const FairnessStats *stats, const char *path) {
+    FILE *file = fopen(path, "wb");
+    uint32_t version = FAIRNESS_VERSION;
+    if (file == NULL || fwrite(FAIRNESS_MAGIC, 1, 4, file) != 4 || fwrite(&version, sizeof(version), 1, file) != 1 ||
+        fwrite(stats, sizeof(*stats), 1, file) != 1) {
+        perror("Failed to write fairness stats");
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+}
+
+// Returns 0 if path is not a fairness stats file of this version
+static inline int fairness_read(FairnessStats *stats, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Failed to open fairness stats");
+        return 0;
+    }
+    char magic[4];
+    uint32_t version;
+    int ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, FAIRNESS_MAGIC, 4) == 0 &&
+             fread(&version, sizeof(version), 1, file) == 1 && version == FAIRNESS_VERSION &&
+             fread(stats, sizeof(*stats), 1, file) == 1;
+    fclose(file);
+    return ok;
+}
+
+#endif
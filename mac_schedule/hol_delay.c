@@ -0,0 +1,595 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scenario.h"
+#include "channel_model.h"
+#include "indexed_heap.h"
+#include "snapshot.h"
+
+// Head-of-line delay schedulers: M-LWDF, EXP/PF and EDF, with plain PF for comparison.
+// Every UE carries delay-critical traffic (delay_kbps, delay_budget_ttis); packets still
+// queued past the budget are dropped.
+//
+// Two indexed d-ary heaps replace the per-TTI sort of proportional_fair2.c:
+//   deadline heap - backlogged UEs keyed on HOL arrival + budget; drives drops, and EDF
+//                   selection directly. Keys only change when the HOL packet changes.
+//   metric heap   - PF only: backlogged UEs keyed on the negated PF metric. Average rates
+//                   are stored divided by rate_scale, which applies every UE's per-TTI decay
+//                   at once, so a key only changes with the UE's MCS or its own rate.
+// The M-LWDF and EXP-PF metrics grow with each UE's HOL delay at a different rate, so their
+// order changes every TTI and no key stays valid; those policies take a plain top-K pass
+// over the backlogged UEs instead. The mean HOL delay EXP-PF needs is kept as a running sum.
+// `--sort` runs the same decisions through a qsort over the backlogged UEs each TTI instead,
+// as a reference for both results and timing. Both orders break ties by UE id.
+//
+// Counters start after warmup_ttis. `--save <file>` writes the warmed-up state (queues, PF
+// averages, heaps, channel and traffic random streams) as a snapshot, `--load <file>` starts
+// from one instead of warming up, and `--branch <variant.cfg>...` forks one run per variant
+// file from the warmed state; a variant may change any key except users and delay_budget_ttis.
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+#define HOL_PACKET_BYTES 100
+#define HOL_QUEUE_SIZE 64           // packets per UE, power of two
+#define HOL_DROP_TARGET 0.05        // M-LWDF / EXP-PF delay violation probability target
+#define PF_AVERAGING_TTIS 100.0
+
+enum { POLICY_PF, POLICY_MLWDF, POLICY_EXPPF, POLICY_EDF };
+
+typedef struct {
+    int user_id;
+    int mcs_index;
+    int queue_head;
+    int queue_length;
+    int packet_arrival[HOL_QUEUE_SIZE];
+    double average_rate;    // divided by rate_scale
+    int total_resource_blocks;
+    int times_scheduled;
+    long long total_data_transmitted;
+    long long packets_arrived;
+    long long packets_delivered;
+    long long packets_dropped;
+} User;
+
+typedef struct {
+    int user_id;
+    double key;
+} RankedUser;
+
+// Scalars saved with a snapshot, checked against the scenario on load
+typedef struct {
+    int users;
+    int delay_budget_ttis;
+    int next_tti;
+    uint32_t traffic_rng;
+    double rate_scale;
+} SnapshotState;
+
+typedef struct {
+    User *users;
+    ChannelModel *channel;
+    int next_tti;
+    char **variants;
+} BranchContext;
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
+int policy;
+int use_sort = 0;
+uint32_t traffic_rng;
+double scheduler_seconds = 0;
+IndexedHeap deadline_heap;
+IndexedHeap metric_heap;
+double rate_scale = 1.0;        // true average rate = User.average_rate * rate_scale
+double hol_arrival_sum = 0;     // HOL arrival TTIs of the UEs in the deadline heap
+// Per-TTI scratch, sized from the scenario once at startup
+int *selected_users;
+RankedUser *ranked_users;
+long long *delay_histogram;     // delivered packets by queueing delay in TTIs, 0..budget
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+int parse_policy(const char *name);
+void generate_traffic(User users[], int num_users, int current_tti);
+double hol_deadline(const User *user);
+double user_metric(const User *user, int current_tti, double mean_delay);
+double mean_hol_delay(int current_tti);
+void remove_deadline(int user_id);
+void update_deadline(User *user);
+void update_metric(User *user);
+void rebuild_metric_heap(User users[], int num_users);
+void decay_rates(User users[], int num_users);
+void drop_expired_packets(User users[], int current_tti);
+int blocks_for_bytes(int mcs_index, double bytes, int max_blocks);
+void assign_resource_blocks(User *user, int num_blocks, int current_tti);
+int compare_ranked_users(const void *a, const void *b);
+int select_users_heap(User users[], int current_tti);
+int select_users_top_k(User users[], int current_tti);
+int select_users_sort(User users[], int num_users, int current_tti);
+void hol_delay_scheduler(User users[], int num_users, int total_resource_blocks, int current_tti);
+void run_ttis(User users[], ChannelModel *channel, int first_tti, int count);
+void reset_counters(User users[], int num_users);
+void print_report(FILE *out, User users[], int num_users, int total_ttis);
+void save_snapshot(const char *path, User users[], const ChannelModel *channel, int next_tti);
+int load_snapshot(const char *path, User users[], ChannelModel *channel);
+void run_branch(int index, FILE *out, void *context);
+
+int main(int argc, char *argv[]) {
+    const char *scenario_path = NULL;
+    const char *save_path = NULL;
+    const char *load_path = NULL;
+    char **variants = NULL;
+    int num_variants = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sort") == 0) {
+            use_sort = 1;
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            load_path = argv[++i];
+        } else if (strcmp(argv[i], "--branch") == 0) {
+            variants = &argv[i + 1];
+            num_variants = argc - i - 1;
+            break;
+        } else {
+            scenario_path = argv[i];
+        }
+    }
+    load_scenario(scenario_path, &scenario);
+
+    policy = parse_policy(scenario.policy);
+    if (policy < 0) {
+        fprintf(stderr, "Unknown policy '%s' (pf, mlwdf, exppf or edf)\n", scenario.policy);
+        return 1;
+    }
+
+    int num_users = scenario.users;
+    User *users = calloc(num_users, sizeof(User));
+    selected_users = malloc(num_users * sizeof(int));
+    ranked_users = malloc(num_users * sizeof(RankedUser));
+    delay_histogram = calloc(scenario.delay_budget_ttis + 1, sizeof(long long));
+
+    generate_TBSArray(TBSArray);
+    unsigned int seed = scenario_seed(&scenario);
+    traffic_rng = seed ^ 0x3C6EF372u ? seed ^ 0x3C6EF372u : 1;
+    indexed_heap_init(&deadline_heap, num_users);
+    indexed_heap_init(&metric_heap, num_users);
+
+    for (int i = 0; i < num_users; i++) {
+        users[i].user_id = i;
+        users[i].average_rate = 1.0;
+    }
+
+    ChannelModel channel;
+    channel_model_init(&channel, num_users, seed);
+
+    printf("THIS IS HEAD-OF-LINE DELAY SCHEDULING (%s, %s)\n", scenario.policy, use_sort ? "per-TTI sort" : "indexed heaps");
+
+    int next_tti = 0;
+    if (load_path != NULL) {
+        next_tti = load_snapshot(load_path, users, &channel);
+        printf("Restored state at TTI %d from %s\n", next_tti, load_path);
+    } else if (scenario.warmup_ttis > 0) {
+        run_ttis(users, &channel, 0, scenario.warmup_ttis);
+        next_tti = scenario.warmup_ttis;
+        reset_counters(users, num_users);
+        printf("Warmed up for %d TTIs\n", next_tti);
+    }
+    if (save_path != NULL) {
+        save_snapshot(save_path, users, &channel, next_tti);
+        printf("Saved state at TTI %d to %s\n", next_tti, save_path);
+    }
+
+    int failed = 0;
+    if (num_variants > 0) {
+        BranchContext context = {users, &channel, next_tti, variants};
+        failed = snapshot_branch(num_variants, run_branch, &context);
+    } else {
+        run_ttis(users, &channel, next_tti, scenario.ttis);
+        print_report(stdout, users, num_users, scenario.ttis);
+    }
+
+    channel_model_free(&channel);
+    indexed_heap_free(&deadline_heap);
+    indexed_heap_free(&metric_heap);
+    free(users);
+    free(selected_users);
+    free(ranked_users);
+    free(delay_histogram);
+    return failed > 0;
+}
+
+void run_ttis(User users[], ChannelModel *channel, int first_tti, int count) {
+    int num_users = scenario.users;
+    struct timespec start, end;
+    rebuild_metric_heap(users, num_users);     // a branch may have switched to or from PF
+    for (int tti = first_tti; tti < first_tti + count; tti++) {
+        channel_model_step(channel);
+        for (int i = 0; i < num_users; i++) {
+            if (users[i].mcs_index != channel->mcs[i]) {
+                users[i].mcs_index = channel->mcs[i];
+                update_metric(&users[i]);
+            }
+        }
+        generate_traffic(users, num_users, tti);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        hol_delay_scheduler(users, num_users, scenario.resource_blocks, tti);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        scheduler_seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    }
+}
+
+// Clears what the report counts; queues, averages and heaps carry on
+void reset_counters(User users[], int num_users) {
+    for (int i = 0; i < num_users; i++) {
+        users[i].total_resource_blocks = 0;
+        users[i].times_scheduled = 0;
+        users[i].total_data_transmitted = 0;
+        users[i].packets_arrived = 0;
+        users[i].packets_delivered = 0;
+        users[i].packets_dropped = 0;
+    }
+    memset(delay_histogram, 0, (scenario.delay_budget_ttis + 1) * sizeof(long long));
+    scheduler_seconds = 0;
+}
+
+void print_report(FILE *out, User users[], int num_users, int total_ttis) {
+    long long total_bytes = 0, arrived = 0, delivered = 0, dropped = 0, times_scheduled = 0;
+    for (int i = 0; i < num_users; i++) {
+        total_bytes += users[i].total_data_transmitted;
+        arrived += users[i].packets_arrived;
+        delivered += users[i].packets_delivered;
+        dropped += users[i].packets_dropped;
+        times_scheduled += users[i].times_scheduled;
+    }
+
+    double delay_sum = 0;
+    int delay_p95 = 0;
+    long long cumulative = 0;
+    for (int d = 0; d <= scenario.delay_budget_ttis; d++) {
+        delay_sum += (double)d * delay_histogram[d];
+        if (cumulative < 0.95 * delivered) {
+            delay_p95 = d;
+        }
+        cumulative += delay_histogram[d];
+    }
+
+    fprintf(out, "Packets arrived = %lld, delivered = %lld, dropped past budget = %lld (%.3f%%)\n",
+            arrived, delivered, dropped, arrived > 0 ? 100.0 * dropped / arrived : 0);
+    fprintf(out, "Average packet delay = %.2f TTIs, 95th percentile = %d TTIs, Grants = %lld\n",
+            delivered > 0 ? delay_sum / delivered : 0, delay_p95, times_scheduled);
+    fprintf(out, "\nAverage throughput over the entire cell = %.3f Mbps\n",
+            (total_bytes * 8 / 1000000.0) / (total_ttis * TTI_DURATION));
+    fprintf(out, "Scheduler time = %.1f ns per TTI\n", scheduler_seconds * 1e9 / total_ttis);
+}
+
+void save_snapshot(const char *path, User users[], const ChannelModel *channel, int next_tti) {
+    SnapshotState state = {scenario.users, scenario.delay_budget_ttis, next_tti, traffic_rng, rate_scale};
+    FILE *file = snapshot_create(path);
+    snapshot_put(file, "state", &state, sizeof(state));
+    snapshot_put(file, "users", users, scenario.users * sizeof(User));
+    snapshot_put(file, "delays", delay_histogram, (scenario.delay_budget_ttis + 1) * sizeof(long long));
+    snapshot_put_heap(file, "dlh", &deadline_heap);
+    snapshot_put_heap(file, "mth", &metric_heap);
+    snapshot_put_channel(file, channel);
+    snapshot_close(file);
+}
+
+// Returns the TTI the snapshot continues from
+int load_snapshot(const char *path, User users[], ChannelModel *channel) {
+    SnapshotState state;
+    FILE *file = snapshot_open(path);
+    snapshot_get(file, "state", &state, sizeof(state));
+    if (state.users != scenario.users || state.delay_budget_ttis != scenario.delay_budget_ttis) {
+        fprintf(stderr, "%s was saved with users = %d, delay_budget_ttis = %d\n", path, state.users, state.delay_budget_ttis);
+        exit(EXIT_FAILURE);
+    }
+    traffic_rng = state.traffic_rng;
+    rate_scale = state.rate_scale;
+    snapshot_get(file, "users", users, scenario.users * sizeof(User));
+    snapshot_get(file, "delays", delay_histogram, (scenario.delay_budget_ttis + 1) * sizeof(long long));
+    snapshot_get_heap(file, "dlh", &deadline_heap);
+    snapshot_get_heap(file, "mth", &metric_heap);
+    snapshot_get_channel(file, channel);
+    fclose(file);
+    hol_arrival_sum = 0;
+    for (int i = 0; i < deadline_heap.size; i++) {
+        hol_arrival_sum += deadline_heap.key[deadline_heap.items[i]] - scenario.delay_budget_ttis;
+    }
+    return state.next_tti;
+}
+
+// Runs in a forked child: applies the variant file over the warmed scenario and measures
+void run_branch(int index, FILE *out, void *context) {
+    BranchContext *branch = (BranchContext *)context;
+    const char *path = branch->variants[index];
+    Scenario base = scenario;
+    scenario_read(path, &scenario);
+    scenario_validate(path, &scenario);
+    if (scenario.users != base.users || scenario.delay_budget_ttis != base.delay_budget_ttis) {
+        fprintf(stderr, "%s: a branch cannot change users or delay_budget_ttis\n", path);
+        exit(EXIT_FAILURE);
+    }
+    policy = parse_policy(scenario.policy);
+    if (policy < 0) {
+        fprintf(stderr, "%s: unknown policy '%s'\n", path, scenario.policy);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out, "\n== %s (%s) ==\n", path, scenario.policy);
+    run_ttis(branch->users, branch->channel, branch->next_tti, scenario.ttis);
+    print_report(out, branch->users, scenario.users, scenario.ttis);
+}
+
+int parse_policy(const char *name) {
+    if (strcmp(name, "pf") == 0) {
+        return POLICY_PF;
+    }
+    if (strcmp(name, "mlwdf") == 0) {
+        return POLICY_MLWDF;
+    }
+    if (strcmp(name, "exppf") == 0) {
+        return POLICY_EXPPF;
+    }
+    if (strcmp(name, "edf") == 0) {
+        return POLICY_EDF;
+    }
+    return -1;
+}
+
+void generate_traffic(User users[], int num_users, int current_tti) {
+    double probability = scenario.delay_kbps * 1000 / 8 * TTI_DURATION / HOL_PACKET_BYTES;
+    for (int i = 0; i < num_users; i++) {
+        User *user = &users[i];
+        if (channel_rng_uniform(&traffic_rng) >= probability) {
+            continue;
+        }
+        user->packets_arrived++;
+        if (user->queue_length == HOL_QUEUE_SIZE) {
+            user->packets_dropped++;
+            continue;
+        }
+        int tail = (user->queue_head + user->queue_length) & (HOL_QUEUE_SIZE - 1);
+        user->packet_arrival[tail] = current_tti;
+        user->queue_length++;
+        if (user->queue_length == 1) {
+            update_deadline(user);
+        }
+    }
+}
+
+double hol_deadline(const User *user) {
+    return user->packet_arrival[user->queue_head] + scenario.delay_budget_ttis;
+}
+
+// Larger is better; mean_delay is the average HOL delay over backlogged UEs (EXP/PF only).
+// pf leaves out the 1 / rate_scale every UE shares, which does not change the order.
+double user_metric(const User *user, int current_tti, double mean_delay) {
+    double pf = TBSArray[user->mcs_index][1] / user->average_rate;
+    double a = -log(HOL_DROP_TARGET) / scenario.delay_budget_ttis;
+    double delay = current_tti - user->packet_arrival[user->queue_head];
+    switch (policy) {
+    case POLICY_MLWDF:
+        return a * (delay + 1) * pf;
+    case POLICY_EXPPF:
+        return exp((a * delay - a * mean_delay) / (1 + sqrt(a * mean_delay))) * pf;
+    case POLICY_EDF:
+        return -hol_deadline(user);
+    default:
+        return pf;
+    }
+}
+
+// Every backlogged UE is in the deadline heap, except EDF's picks while they are served
+double mean_hol_delay(int current_tti) {
+    if (policy != POLICY_EXPPF || deadline_heap.size == 0) {
+        return 0;
+    }
+    return current_tti - hol_arrival_sum / deadline_heap.size;
+}
+
+void remove_deadline(int user_id) {
+    if (indexed_heap_contains(&deadline_heap, user_id)) {
+        hol_arrival_sum -= deadline_heap.key[user_id] - scenario.delay_budget_ttis;
+        indexed_heap_remove(&deadline_heap, user_id);
+    }
+}
+
+// Keeps the heaps in step with the UE's head-of-line packet and rate
+void update_deadline(User *user) {
+    remove_deadline(user->user_id);
+    if (user->queue_length > 0) {
+        hol_arrival_sum += user->packet_arrival[user->queue_head];
+        indexed_heap_update(&deadline_heap, user->user_id, hol_deadline(user));
+    }
+    update_metric(user);
+}
+
+// Called whenever the UE's backlog, MCS or average rate changes
+void update_metric(User *user) {
+    if (policy == POLICY_PF && !use_sort && user->queue_length > 0) {
+        indexed_heap_update(&metric_heap, user->user_id, -user_metric(user, 0, 0));
+    } else {
+        indexed_heap_remove(&metric_heap, user->user_id);
+    }
+}
+
+void rebuild_metric_heap(User users[], int num_users) {
+    for (int i = 0; i < num_users; i++) {
+        update_metric(&users[i]);
+    }
+}
+
+// One TTI of PF averaging for every UE: only rate_scale moves, until it gets small enough
+// to fold back into the stored rates
+void decay_rates(User users[], int num_users) {
+    rate_scale *= 1.0 - 1.0 / PF_AVERAGING_TTIS;
+    if (rate_scale > 1e-100) {
+        return;
+    }
+    for (int i = 0; i < num_users; i++) {
+        users[i].average_rate *= rate_scale;
+    }
+    rate_scale = 1.0;
+    rebuild_metric_heap(users, num_users);
+}
+
+// Expired head-of-line packets sit at the top of the deadline heap
+void drop_expired_packets(User users[], int current_tti) {
+    while (deadline_heap.size > 0 && indexed_heap_top_key(&deadline_heap) < current_tti) {
+        User *user = &users[indexed_heap_top(&deadline_heap)];
+        user->queue_head = (user->queue_head + 1) & (HOL_QUEUE_SIZE - 1);
+        user->queue_length--;
+        user->packets_dropped++;
+        update_deadline(user);
+    }
+}
+
+// Smallest allocation whose transport block carries bytes, capped at max_blocks
+int blocks_for_bytes(int mcs_index, double bytes, int max_blocks) {
+    int low = 1, high = max_blocks;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (TBSArray[mcs_index][mid] >= bytes) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+void assign_resource_blocks(User *user, int num_blocks, int current_tti) {
+    int packets = TBSArray[user->mcs_index][num_blocks] / HOL_PACKET_BYTES;
+    if (packets > user->queue_length) {
+        packets = user->queue_length;
+    }
+    for (int p = 0; p < packets; p++) {
+        delay_histogram[current_tti - user->packet_arrival[user->queue_head]]++;
+        user->queue_head = (user->queue_head + 1) & (HOL_QUEUE_SIZE - 1);
+    }
+    user->queue_length -= packets;
+    user->packets_delivered += packets;
+    user->total_resource_blocks += num_blocks;
+    user->times_scheduled += 1;
+    user->total_data_transmitted += packets * HOL_PACKET_BYTES;
+    user->average_rate += packets * HOL_PACKET_BYTES / PF_AVERAGING_TTIS / rate_scale;
+    update_deadline(user);
+}
+
+int compare_ranked_users(const void *a, const void *b) {
+    const RankedUser *x = (const RankedUser *)a;
+    const RankedUser *y = (const RankedUser *)b;
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return x->user_id - y->user_id;
+}
+
+// Fills selected_users[] with the best backlogged UEs from the heaps and returns how many.
+// Selected UEs are taken out of the selection heap; the caller puts them back.
+int select_users_heap(User users[], int current_tti) {
+    if (policy == POLICY_MLWDF || policy == POLICY_EXPPF) {
+        return select_users_top_k(users, current_tti);
+    }
+    IndexedHeap *heap = policy == POLICY_EDF ? &deadline_heap : &metric_heap;
+    int count = 0;
+    while (count < scenario.users_per_tti && heap->size > 0) {
+        int user_id = indexed_heap_top(heap);
+        if (heap == &deadline_heap) {
+            remove_deadline(user_id);
+        } else {
+            indexed_heap_remove(heap, user_id);
+        }
+        selected_users[count++] = user_id;
+    }
+    return count;
+}
+
+// M-LWDF and EXP-PF: the users_per_tti best of the backlogged UEs (the deadline heap's items),
+// kept sorted by insertion in ranked_users[]
+int select_users_top_k(User users[], int current_tti) {
+    double mean_delay = mean_hol_delay(current_tti);
+    int limit = scenario.users_per_tti;
+    int found = 0;
+    for (int i = 0; i < deadline_heap.size; i++) {
+        RankedUser candidate = {deadline_heap.items[i], 0};
+        candidate.key = -user_metric(&users[candidate.user_id], current_tti, mean_delay);
+        if (found == limit && compare_ranked_users(&candidate, &ranked_users[limit - 1]) >= 0) {
+            continue;
+        }
+        int pos = found < limit ? found++ : limit - 1;
+        while (pos > 0 && compare_ranked_users(&candidate, &ranked_users[pos - 1]) < 0) {
+            ranked_users[pos] = ranked_users[pos - 1];
+            pos--;
+        }
+        ranked_users[pos] = candidate;
+    }
+    for (int i = 0; i < found; i++) {
+        selected_users[i] = ranked_users[i].user_id;
+    }
+    return found;
+}
+
+// Reference selection: rank every backlogged UE with qsort
+int select_users_sort(User users[], int num_users, int current_tti) {
+    double mean_delay = mean_hol_delay(current_tti);
+    int backlogged = 0;
+    for (int i = 0; i < num_users; i++) {
+        if (users[i].queue_length > 0) {
+            ranked_users[backlogged].user_id = i;
+            ranked_users[backlogged].key = policy == POLICY_EDF ? hol_deadline(&users[i])
+                                                                : -user_metric(&users[i], current_tti, mean_delay);
+            backlogged++;
+        }
+    }
+    qsort(ranked_users, backlogged, sizeof(RankedUser), compare_ranked_users);
+
+    int count = backlogged < scenario.users_per_tti ? backlogged : scenario.users_per_tti;
+    for (int i = 0; i < count; i++) {
+        selected_users[i] = ranked_users[i].user_id;
+    }
+    return count;
+}
+
+void hol_delay_scheduler(User users[], int num_users, int total_resource_blocks, int current_tti) {
+    int resource_blocks = total_resource_blocks;
+
+    decay_rates(users, num_users);
+    drop_expired_packets(users, current_tti);
+
+    int count = use_sort ? select_users_sort(users, num_users, current_tti)
+                         : select_users_heap(users, current_tti);
+
+    // In priority order, each selected UE gets the RBs that empty its queue
+    for (int i = 0; i < count && resource_blocks > 0; i++) {
+        User *user = &users[selected_users[i]];
+        int blocks = blocks_for_bytes(user->mcs_index, (double)user->queue_length * HOL_PACKET_BYTES, resource_blocks);
+        assign_resource_blocks(user, blocks, current_tti);
+        resource_blocks -= blocks;
+    }
+
+    // Heap selection popped UEs off the deadline or metric heap; put back the ones still
+    // backlogged (served ones were already updated, the rest were left out)
+    if ((policy == POLICY_EDF || policy == POLICY_PF) && !use_sort) {
+        for (int i = 0; i < count; i++) {
+            update_deadline(&users[selected_users[i]]);
+        }
+    }
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
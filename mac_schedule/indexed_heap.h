@@ -0,0 +1,132 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// d-ary min-heap over item ids 0..capacity-1 with a position index, so an item's key can
+// be changed or the item removed in O(log N) without searching for it. A wider node keeps
+// the tree shallow and puts all children of a node on the same cache line or two, which
+// pays off when most operations are key updates that move an item a level or two.
+// Equal keys are ordered by item id, so the order is total and matches a sort on (key, id).
+
+#ifndef INDEXED_HEAP_ARITY
+#define INDEXED_HEAP_ARITY 4
+#endif
+
+typedef struct {
+    int capacity;
+    int size;
+    int *items;         // heap order
+    int *position;      // per item: index in items[], -1 when not in the heap
+    double *key;        // per item
+} IndexedHeap;
+
+static inline void indexed_heap_init(IndexedHeap *heap, int capacity) {
+    heap->capacity = capacity;
+    heap->size = 0;
+    heap->items = malloc(capacity * sizeof(int));
+    heap->position = malloc(capacity * sizeof(int));
+    heap->key = malloc(capacity * sizeof(double));
+    if (heap->items == NULL || heap->position == NULL || heap->key == NULL) {
+        perror("Failed to allocate heap");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < capacity; i++) {
+        heap->position[i] = -1;
+    }
+}
+
+static inline void indexed_heap_free(IndexedHeap *heap) {
+    free(heap->items);
+    free(heap->position);
+    free(heap->key);
+}
+
+static inline int indexed_heap_contains(const IndexedHeap *heap, int item) {
+    return heap->position[item] >= 0;
+}
+
+static inline int indexed_heap_less(const IndexedHeap *heap, int a, int b) {
+    return heap->key[a] < heap->key[b] || (heap->key[a] == heap->key[b] && a < b);
+}
+
+static inline void indexed_heap_place(IndexedHeap *heap, int index, int item) {
+    heap->items[index] = item;
+    heap->position[item] = index;
+}
+
+static inline void indexed_heap_sift_up(IndexedHeap *heap, int index) {
+    int item = heap->items[index];
+    while (index > 0) {
+        int parent = (index - 1) / INDEXED_HEAP_ARITY;
+        if (!indexed_heap_less(heap, item, heap->items[parent])) {
+            break;
+        }
+        indexed_heap_place(heap, index, heap->items[parent]);
+        index = parent;
+    }
+    indexed_heap_place(heap, index, item);
+}
+
+static inline void indexed_heap_sift_down(IndexedHeap *heap, int index) {
+    int item = heap->items[index];
+    while (1) {
+        int first = INDEXED_HEAP_ARITY * index + 1;
+        if (first >= heap->size) {
+            break;
+        }
+        int last = first + INDEXED_HEAP_ARITY < heap->size ? first + INDEXED_HEAP_ARITY : heap->size;
+        int child = first;
+        for (int c = first + 1; c < last; c++) {
+            if (indexed_heap_less(heap, heap->items[c], heap->items[child])) {
+                child = c;
+            }
+        }
+        if (!indexed_heap_less(heap, heap->items[child], item)) {
+            break;
+        }
+        indexed_heap_place(heap, index, heap->items[child]);
+        index = child;
+    }
+    indexed_heap_place(heap, index, item);
+}
+
+// Inserts item, or moves it if it is already in the heap
+static inline void indexed_heap_update(IndexedHeap *heap, int item, double key) {
+    if (heap->position[item] < 0) {
+        heap->key[item] = key;
+        indexed_heap_place(heap, heap->size++, item);
+        indexed_heap_sift_up(heap, heap->size - 1);
+        return;
+    }
+    heap->key[item] = key;
+    indexed_heap_sift_up(heap, heap->position[item]);
+    indexed_heap_sift_down(heap, heap->position[item]);
+}
+
+static inline void indexed_heap_remove(IndexedHeap *heap, int item) {
+    int index = heap->position[item];
+    if (index < 0) {
+        return;
+    }
+    heap->position[item] = -1;
+    int last = heap->items[--heap->size];
+    if (index == heap->size) {
+        return;
+    }
+    indexed_heap_place(heap, index, last);
+    indexed_heap_sift_up(heap, index);
+    indexed_heap_sift_down(heap, heap->position[last]);
+}
+
+// Item with the smallest key; only valid when size > 0
+static inline int indexed_heap_top(const IndexedHeap *heap) {
+    return heap->items[0];
+}
+
+static inline double indexed_heap_top_key(const IndexedHeap *heap) {
+    return heap->key[heap->items[0]];
+}
+
+#endif
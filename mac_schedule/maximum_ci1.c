@@ -3,15 +3,18 @@
 #include <time.h>
 #include <unistd.h>
 
-#define MAX_USERS 12
-#define USERS_PER_TTI 4
-#define MAX_TTIS 10000
+#include "scenario.h"
+
 #define MAX_MCS_INDEX 28
-#define MAX_RB 100
+#define MAX_RB SCENARIO_MAX_RB
 #define TTI_DURATION 0.001
 #define MCS_COUNT (MAX_MCS_INDEX + 1)
+#define CQI_REPORT_ERROR_DB 2.0
+
+#include "olla.h"
 
 int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
 typedef struct {
     int user_id;
     int mcs_index;
@@ -19,6 +22,11 @@ typedef struct {
     int current_resource_blocks; 
     int times_scheduled;
     long long total_data_transmitted;
+    double reported_sinr_db;
+    double channel_sinr_db;
+    double olla_offset_db;
+    int transmissions;
+    int nacks;
 } User;
 
 void assign_resource_blocks(User *user, int num_blocks);
@@ -29,25 +37,32 @@ void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
 void shuffle(int array[], int n);
 void generate_and_save_mcs_indices();
 void load_mcs_indices(User users[], int num_users);
+void link_adaptation(User users[], int num_users);
 
-int main() {
-    User users[MAX_USERS];
-    int total_resource_blocks;
-    int total_ttis = MAX_TTIS;
-    int num_users = MAX_USERS;
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
+
+    User *users = malloc(scenario.users * sizeof(User));
+    int total_resource_blocks = scenario.resource_blocks;
+    int total_ttis = scenario.ttis;
+    int num_users = scenario.users;
 
     generate_TBSArray(TBSArray);
+    olla_init_tables();
+    srand(scenario_seed(&scenario));
 
     // Initialize users
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         users[i].user_id = i;
         users[i].total_resource_blocks = 0;
         users[i].current_resource_blocks = 0;
         users[i].times_scheduled = 0;
         users[i].total_data_transmitted = 0;
+        users[i].transmissions = 0;
+        users[i].nacks = 0;
     }
 
-    if (access("mcs_indices.dat", F_OK) == -1) {
+    if (access(scenario.mcs_file, F_OK) == -1) {
         generate_and_save_mcs_indices();
     }
 
@@ -59,29 +74,30 @@ int main() {
 
     printf("THIS IS MAXIMUM C/I WITH FIXED MCS ALGORITHM\n");
 
-    printf("Enter total number of resource blocks per TTI: ");
-    scanf("%d", &total_resource_blocks);
 
     // Perform maximum CI scheduling over multiple TTIs
     for (int tti = 0; tti < total_ttis; tti++) {
-        maximum_ci_scheduler(users, MAX_USERS, total_resource_blocks);
+        link_adaptation(users, num_users);
+        maximum_ci_scheduler(users, num_users, total_resource_blocks);
     }
 
     // Print resource blocks assigned to each user
-    for (int i = 0; i < MAX_USERS; i++) {
-        printf("User %d: Total RBs over %d TTIs = %d, Average per TTI = %.2f, Times scheduled = %d, Average throughput = %.3f Mbps\n",
+    for (int i = 0; i < num_users; i++) {
+        printf("User %d: Total RBs over %d TTIs = %d, Average per TTI = %.2f, Times scheduled = %d, Average throughput = %.3f Mbps, BLER = %.3f\n",
                users[i].user_id, total_ttis, users[i].total_resource_blocks,
-               (float)users[i].total_resource_blocks / total_ttis, users[i].times_scheduled, (users[i].total_data_transmitted * 8 / 1000000)/(total_ttis*TTI_DURATION));
+               (float)users[i].total_resource_blocks / total_ttis, users[i].times_scheduled, (users[i].total_data_transmitted * 8 / 1000000)/(total_ttis*TTI_DURATION),
+               users[i].transmissions ? (float)users[i].nacks / users[i].transmissions : 0.0f);
     }
 
     // Calculate total bytes transmitted by all users
     long long total_bytes_all_users = 0;
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         total_bytes_all_users += users[i].total_data_transmitted;
     }
 
     printf("\nAverage throughput over the entire cell = %.3f Mbps\n", (total_bytes_all_users * 8 / 1000000)/(total_ttis*TTI_DURATION));
 
+    free(users);
     return 0;
 }
 
@@ -89,7 +105,16 @@ void assign_resource_blocks(User *user, int num_blocks) {
     user->current_resource_blocks += num_blocks;
     user->total_resource_blocks += num_blocks;
     user->times_scheduled += 1;
-    user->total_data_transmitted += TBSArray[user->mcs_index][num_blocks];
+
+    // HARQ feedback drives the outer loop; only acknowledged blocks count as delivered
+    int ack = olla_harq_ack(user->channel_sinr_db, user->mcs_index);
+    olla_update(&user->olla_offset_db, ack);
+    user->transmissions += 1;
+    if (ack) {
+        user->total_data_transmitted += TBSArray[user->mcs_index][num_blocks];
+    } else {
+        user->nacks += 1;
+    }
 }
 
 void reset_resource_blocks(User *user) {
@@ -104,19 +129,16 @@ int compare_users(const void *a, const void *b) {
 
 void maximum_ci_scheduler(User users[], int num_users, int total_resource_blocks) {
     qsort(users, num_users, sizeof(User), compare_users);
-    int blocks_per_user = total_resource_blocks / USERS_PER_TTI;
-    int remaining_blocks = total_resource_blocks % USERS_PER_TTI;
+    int blocks_per_user = total_resource_blocks / scenario.users_per_tti;
+    int remaining_blocks = total_resource_blocks % scenario.users_per_tti;
     // Reset resource blocks for selected users
-    for (int i = 0; i < USERS_PER_TTI; i++) {
+    for (int i = 0; i < scenario.users_per_tti; i++) {
         reset_resource_blocks(&users[i]);
     }
-    // Distribute blocks to the highest mcs_index users in the current window
-    for (int i = 0; i < USERS_PER_TTI; i++) {
-        assign_resource_blocks(&users[i], blocks_per_user);
-    }
-    // Distribute remaining blocks
-    for (int i = 0; i < remaining_blocks; i++) {
-        assign_resource_blocks(&users[i % USERS_PER_TTI], 1);
+    // Distribute blocks to the highest mcs_index users in the current window, the remainder
+    // one each to the first of them, so every user gets one grant per TTI
+    for (int i = 0; i < scenario.users_per_tti; i++) {
+        assign_resource_blocks(&users[i], blocks_per_user + (i < remaining_blocks));
     }
 }
 
@@ -143,7 +165,7 @@ void shuffle(int array[], int n) {
 
 void generate_and_save_mcs_indices() {
     int mcs_indices[MCS_COUNT];
-    FILE *file = fopen("mcs_indices.dat", "wb");
+    FILE *file = fopen(scenario.mcs_file, "wb");
     if (file == NULL) {
         perror("Failed to open file");
         exit(EXIT_FAILURE);
@@ -161,7 +183,7 @@ void generate_and_save_mcs_indices() {
 
 void load_mcs_indices(User users[], int num_users) {
     int mcs_indices[MCS_COUNT];
-    FILE *file = fopen("mcs_indices.dat", "rb");
+    FILE *file = fopen(scenario.mcs_file, "rb");
     if (file == NULL) {
         perror("Failed to open file");
         exit(EXIT_FAILURE);
@@ -173,6 +195,17 @@ void load_mcs_indices(User users[], int num_users) {
     // Assign MCS indices to users
     for (int i = 0; i < num_users; i++) {
         users[i].mcs_index = mcs_indices[i % MCS_COUNT];
+
+        // The loaded MCS is the UE's CQI report; the real channel differs by a fixed report error
+        users[i].reported_sinr_db = olla_mcs_sinr_db(users[i].mcs_index);
+        users[i].channel_sinr_db = users[i].reported_sinr_db + ((double)rand() / RAND_MAX * 2.0 - 1.0) * CQI_REPORT_ERROR_DB;
+        users[i].olla_offset_db = 0.0;
+    }
+}
+
+void link_adaptation(User users[], int num_users) {
+    for (int i = 0; i < num_users; i++) {
+        users[i].mcs_index = olla_select_mcs(users[i].reported_sinr_db, users[i].olla_offset_db);
     }
 }
 
@@ -2,14 +2,15 @@
 #include <stdlib.h>
 #include <time.h>
 
-#define MAX_USERS 12
-#define USERS_PER_TTI 4
-#define MAX_TTIS 10000
+#include "scenario.h"
+#include "channel_model.h"
+
 #define MAX_MCS_INDEX 28
-#define MAX_RB 100
+#define MAX_RB SCENARIO_MAX_RB
 #define TTI_DURATION 0.001
 
 int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
 typedef struct {
     int user_id;
     int mcs_index;
@@ -24,19 +25,20 @@ void reset_resource_blocks(User *user);
 int compare_users(const void *a, const void *b);
 void maximum_ci_scheduler(User users[], int num_users, int total_resource_blocks);
 void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
-void shuffle(int array[], int n);
-void generate_unique_random_mcs(User users[], int num_users);
+void update_channel_mcs(User users[], int num_users, ChannelModel *channel);
+
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
 
-int main() {
-    User users[MAX_USERS];
-    int total_resource_blocks;
-    int total_ttis = MAX_TTIS;
-    int num_users = MAX_USERS;
+    User *users = malloc(scenario.users * sizeof(User));
+    int total_resource_blocks = scenario.resource_blocks;
+    int total_ttis = scenario.ttis;
+    int num_users = scenario.users;
 
     generate_TBSArray(TBSArray);
 
     // Initialize users
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         users[i].user_id = i;
         users[i].total_resource_blocks = 0;
         users[i].current_resource_blocks = 0;
@@ -44,20 +46,31 @@ int main() {
         users[i].total_data_transmitted = 0;
     }
 
-    srand(time(NULL));
+    ChannelModel channel;
+    channel_model_init(&channel, num_users, scenario_seed(&scenario));
+    ChannelTraceHeader trace_header;
+    FILE *trace = NULL;
+    if (scenario.channel_trace[0] != '\0') {
+        trace = channel_trace_open(scenario.channel_trace, num_users, total_ttis, &trace_header);
+    }
 
     printf("THIS IS MAXIMUM C/I WITH MCS CHANGED EVERY TTI ALGORITHM\n");
-    printf("Enter total number of resource blocks per TTI: ");
-    scanf("%d", &total_resource_blocks);
 
     // Perform maximum CI scheduling over multiple TTIs
     for (int tti = 0; tti < total_ttis; tti++) {
-        generate_unique_random_mcs(users, num_users);
-        maximum_ci_scheduler(users, MAX_USERS, total_resource_blocks);
+        // A trace replaces the model: its MCS row for the TTI goes where the model's would
+        if (trace == NULL) {
+            channel_model_step(&channel);
+        } else if (!channel_trace_read_tti(trace, &trace_header, channel.mcs)) {
+            fprintf(stderr, "Channel trace %s ended at TTI %d\n", scenario.channel_trace, tti);
+            exit(EXIT_FAILURE);
+        }
+        update_channel_mcs(users, num_users, &channel);
+        maximum_ci_scheduler(users, num_users, total_resource_blocks);
     }
 
     // Print resource blocks assigned to each user
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         printf("User %d: Total RBs over %d TTIs = %d, Average per TTI = %.2f, Times scheduled = %d, Average throughput = %.3f Mbps\n",
                users[i].user_id, total_ttis, users[i].total_resource_blocks,
                (float)users[i].total_resource_blocks / total_ttis, users[i].times_scheduled, (users[i].total_data_transmitted * 8 / 1000000)/(total_ttis*TTI_DURATION));
@@ -65,12 +78,17 @@ int main() {
 
     // Calculate total bytes transmitted by all users
     long long total_bytes_all_users = 0;
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         total_bytes_all_users += users[i].total_data_transmitted;
     }
 
     printf("\nAverage throughput over the entire cell = %.3f Mbps\n", (total_bytes_all_users * 8 / 1000000)/(total_ttis*TTI_DURATION));
 
+    if (trace != NULL) {
+        fclose(trace);
+    }
+    channel_model_free(&channel);
+    free(users);
     return 0;
 }
 
@@ -93,19 +111,19 @@ int compare_users(const void *a, const void *b) {
 
 void maximum_ci_scheduler(User users[], int num_users, int total_resource_blocks) {
     qsort(users, num_users, sizeof(User), compare_users);
-    int blocks_per_user = total_resource_blocks / USERS_PER_TTI;
-    int remaining_blocks = total_resource_blocks % USERS_PER_TTI;
+    int blocks_per_user = total_resource_blocks / scenario.users_per_tti;
+    int remaining_blocks = total_resource_blocks % scenario.users_per_tti;
     // Reset resource blocks for selected users
-    for (int i = 0; i < USERS_PER_TTI; i++) {
+    for (int i = 0; i < scenario.users_per_tti; i++) {
         reset_resource_blocks(&users[i]);
     }
     // Distribute blocks to the highest mcs_index users in the current window
-    for (int i = 0; i < USERS_PER_TTI; i++) {
+    for (int i = 0; i < scenario.users_per_tti; i++) {
         assign_resource_blocks(&users[i], blocks_per_user);
     }
     // Distribute remaining blocks
     for (int i = 0; i < remaining_blocks; i++) {
-        assign_resource_blocks(&users[i % USERS_PER_TTI], 1);
+        assign_resource_blocks(&users[i % scenario.users_per_tti], 1);
     }
 }
 
@@ -121,22 +139,9 @@ void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
     }
 }
 
-void shuffle(int array[], int n) {
-    for (int i = n - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        int temp = array[i];
-        array[i] = array[j];
-        array[j] = temp;
-    }
-}
-
-void generate_unique_random_mcs(User users[], int num_users) {
-    int mcs_indices[MAX_MCS_INDEX + 1];
-    for (int i = 0; i <= MAX_MCS_INDEX; i++) {
-        mcs_indices[i] = i;
-    }
-    shuffle(mcs_indices, MAX_MCS_INDEX + 1);
+void update_channel_mcs(User users[], int num_users, ChannelModel *channel) {
+    // Users may have been reordered by the scheduler, so look the channel up by user_id
     for (int i = 0; i < num_users; i++) {
-        users[i].mcs_index = mcs_indices[i];
+        users[i].mcs_index = channel->mcs[users[i].user_id];
     }
 }
@@ -0,0 +1,203 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scenario.h"
+#include "mu_mimo.h"
+#include "scheduler_policy.h"
+
+// Proportional fair scheduling per RBG with MU-MIMO co-scheduling. Every RBG goes to a group
+// of up to scenario.layers UEs chosen by mu_mimo_pair() from the best PF candidates. Each UE
+// gets one transport block per TTI, at the MCS of its weakest RBG. The same cell is run once
+// more with one layer as the single-user reference.
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+#define MU_MIMO_CANDIDATES 32
+#define PF_AVERAGING_TTIS 100.0f
+
+typedef struct {
+    double cell_throughput;
+    double layers_per_rbg;
+    double fairness;
+    double ns_per_tti;
+} MuMimoResult;
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+int rbg_size(int resource_blocks);
+int select_candidates(const float *su_rate, const float *weight, int num_users, int *candidates);
+MuMimoResult run_cell(int layers, unsigned int seed);
+
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
+    generate_TBSArray(TBSArray);
+    unsigned int seed = scenario_seed(&scenario);
+
+    printf("THIS IS MU-MIMO PROPORTIONAL FAIR SCHEDULING (%d antennas, %d UEs, up to %d layers, RBG = %d RBs)\n",
+           scenario.antennas, scenario.users, scenario.layers, rbg_size(scenario.resource_blocks));
+
+    MuMimoResult mu = run_cell(scenario.layers, seed);
+    MuMimoResult su = run_cell(1, seed);
+
+    printf("\n%-10s %18s %16s %10s %12s\n", "", "Throughput (Mbps)", "UEs per RBG", "Fairness", "ns per TTI");
+    printf("%-10s %18.3f %16.2f %10.4f %12.0f\n", "MU-MIMO", mu.cell_throughput, mu.layers_per_rbg, mu.fairness, mu.ns_per_tti);
+    printf("%-10s %18.3f %16.2f %10.4f %12.0f\n", "SU-MIMO", su.cell_throughput, su.layers_per_rbg, su.fairness, su.ns_per_tti);
+    printf("\nMU-MIMO gain over single-user = %.2fx\n", su.cell_throughput > 0 ? mu.cell_throughput / su.cell_throughput : 0);
+    return 0;
+}
+
+// RBG size for configuration 1 of TS 38.214 table 5.1.2.2.1-1
+int rbg_size(int resource_blocks) {
+    if (resource_blocks <= 36) {
+        return 2;
+    }
+    if (resource_blocks <= 72) {
+        return 4;
+    }
+    if (resource_blocks <= 144) {
+        return 8;
+    }
+    return 16;
+}
+
+// Keeps the MU_MIMO_CANDIDATES best single-user PF metrics in descending order and returns how many
+int select_candidates(const float *su_rate, const float *weight, int num_users, int *candidates) {
+    float keys[MU_MIMO_CANDIDATES];
+    int count = num_users < MU_MIMO_CANDIDATES ? num_users : MU_MIMO_CANDIDATES;
+    int found = 0;
+    for (int i = 0; i < num_users; i++) {
+        float key = weight[i] * su_rate[i];
+        scheduler_top_k_float(key, i, count, &found, keys, candidates);
+    }
+    return count;
+}
+
+MuMimoResult run_cell(int layers, unsigned int seed) {
+    int num_users = scenario.users;
+    int total_ttis = scenario.ttis;
+    int rbg = rbg_size(scenario.resource_blocks);
+    int num_rbgs = (scenario.resource_blocks + rbg - 1) / rbg;
+    float array_gain = (float)scenario.antennas;
+
+    ChannelModel channel;
+    MuMimoPrecoders precoders;
+    channel_model_init(&channel, num_users, seed);
+    mu_mimo_init(&precoders, num_users, scenario.antennas, seed);
+
+    float *sinr_linear = malloc(num_users * sizeof(float));
+    float *su_rate = malloc(num_users * sizeof(float));     // single-user spectral efficiency
+    float *average_rate = malloc(num_users * sizeof(float));
+    float *weight = malloc(num_users * sizeof(float));
+    float *granted = calloc(num_users, sizeof(float));     // estimated bytes already given this TTI
+    int *tti_blocks = calloc(num_users, sizeof(int));
+    int *tti_mcs = malloc(num_users * sizeof(int));
+    int *scheduled = malloc(num_users * sizeof(int));
+    long long *bytes = calloc(num_users, sizeof(long long));
+    int candidates[MU_MIMO_CANDIDATES];
+    int group[MU_MIMO_MAX_LAYERS];
+    float group_sinr[MU_MIMO_MAX_LAYERS];
+    long long group_members = 0;
+
+    for (int i = 0; i < num_users; i++) {
+        average_rate[i] = 1.0f;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int tti = 0; tti < total_ttis; tti++) {
+        channel_model_step(&channel);
+        if (tti % MU_MIMO_CSI_PERIOD == 0) {
+            mu_mimo_update(&precoders, &channel);
+        }
+        for (int i = 0; i < num_users; i++) {
+            sinr_linear[i] = expf(channel.sinr_db[i] * 0.23025851f);
+            su_rate[i] = log2f(1.0f + array_gain * sinr_linear[i]);
+        }
+
+        int num_scheduled = 0;
+        for (int r = 0; r < num_rbgs; r++) {
+            int blocks = r == num_rbgs - 1 ? scenario.resource_blocks - r * rbg : rbg;
+
+            // PF weight counts what the UE has already been given on earlier RBGs of this TTI
+            for (int i = 0; i < num_users; i++) {
+                weight[i] = 1.0f / (average_rate[i] + granted[i]);
+            }
+            int count = select_candidates(su_rate, weight, num_users, candidates);
+            int size = mu_mimo_pair(&precoders, sinr_linear, weight, candidates, count, layers,
+                                    (float)scenario.max_correlation, group, group_sinr);
+            group_members += size;
+
+            for (int m = 0; m < size; m++) {
+                int ue = group[m];
+                int mcs = mu_mimo_mcs(group_sinr[m]);
+                if (tti_blocks[ue] == 0) {
+                    scheduled[num_scheduled++] = ue;
+                    tti_mcs[ue] = mcs;
+                } else if (mcs < tti_mcs[ue]) {
+                    tti_mcs[ue] = mcs;
+                }
+                tti_blocks[ue] += blocks;
+                granted[ue] += TBSArray[mcs][blocks];
+            }
+        }
+
+        for (int i = 0; i < num_users; i++) {
+            average_rate[i] *= 1.0f - 1.0f / PF_AVERAGING_TTIS;
+        }
+        for (int s = 0; s < num_scheduled; s++) {
+            int ue = scheduled[s];
+            int tbs = TBSArray[tti_mcs[ue]][tti_blocks[ue]];
+            bytes[ue] += tbs;
+            average_rate[ue] += tbs / PF_AVERAGING_TTIS;
+            tti_blocks[ue] = 0;
+            granted[ue] = 0;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double sum = 0, sum_squares = 0;
+    for (int i = 0; i < num_users; i++) {
+        sum += bytes[i];
+        sum_squares += (double)bytes[i] * bytes[i];
+    }
+
+    MuMimoResult result;
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    result.cell_throughput = (sum * 8 / 1000000.0) / (total_ttis * TTI_DURATION);
+    result.layers_per_rbg = (double)group_members / ((double)total_ttis * num_rbgs);
+    result.fairness = sum_squares > 0 ? sum * sum / (num_users * sum_squares) : 0;
+    result.ns_per_tti = elapsed * 1e9 / total_ttis;
+
+    free(sinr_linear);
+    free(su_rate);
+    free(average_rate);
+    free(weight);
+    free(granted);
+    free(tti_blocks);
+    free(tti_mcs);
+    free(scheduled);
+    free(bytes);
+    mu_mimo_free(&precoders);
+    channel_model_free(&channel);
+    return result;
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
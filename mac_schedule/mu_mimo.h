@@ -0,0 +1,238 @@
+#ifndef MU_MIMO_H
+#define MU_MIMO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "channel_model.h"
+
+// MU-MIMO co-scheduling: per-UE precoders for an antenna array and greedy pairing of up to
+// `layers` UEs on one RBG.
+//
+// Each UE's channel is a uniform linear array steering vector towards its position in the
+// ChannelModel plus an AR(1) Rayleigh scattering part; the precoder is that vector
+// normalized (MRT), refreshed every MU_MIMO_CSI_PERIOD TTIs like a periodic CSI report.
+// Precoders are stored one padded row per UE, real and imaginary parts in separate arrays,
+// so the correlation and update loops run over antennas in SIMD registers
+// (build with -O3 -ffast-math -march=native).
+//
+// Co-scheduled UEs share the transmit power equally and leak into each other in proportion
+// to their precoder correlation |w_i^H w_j|^2:
+//   sinr_i = (g * s_i / L) / (1 + g * s_i / L * sum_j corr_ij),  g = array gain (antennas)
+
+#define MU_MIMO_MAX_LAYERS 16      // matches SCENARIO_MAX_LAYERS
+#define MU_MIMO_CSI_PERIOD 5
+#define MU_MIMO_SCATTER_POWER 0.2f
+
+typedef struct {
+    int num_ues;
+    int num_antennas;
+    int stride;             // floats per UE row, padded to a cache line
+    float *w_re;            // unit-norm precoder, [ue * stride + antenna]
+    float *w_im;
+    float *scatter_re;      // scattering part of the channel, same layout
+    float *scatter_im;
+    uint32_t *rng;          // one xorshift stream per antenna element
+} MuMimoPrecoders;
+
+static inline void mu_mimo_init(MuMimoPrecoders *precoders, int num_ues, int num_antennas, uint32_t seed) {
+    int stride = (num_antennas + 15) & ~15;
+    size_t size = (size_t)num_ues * stride;
+    precoders->num_ues = num_ues;
+    precoders->num_antennas = num_antennas;
+    precoders->stride = stride;
+    precoders->w_re = channel_alloc(size, sizeof(float));
+    precoders->w_im = channel_alloc(size, sizeof(float));
+    precoders->scatter_re = channel_alloc(size, sizeof(float));
+    precoders->scatter_im = channel_alloc(size, sizeof(float));
+    precoders->rng = channel_alloc(size, sizeof(uint32_t));
+    memset(precoders->w_re, 0, size * sizeof(float));
+    memset(precoders->w_im, 0, size * sizeof(float));
+
+    for (size_t i = 0; i < size; i++) {
+        uint32_t state = (seed ^ 0x2545F491u) + (uint32_t)i * 0x9E3779B9u;
+        if (state == 0) {
+            state = 1;
+        }
+        for (int k = 0; k < 4; k++) {
+            channel_rng_next(&state);
+        }
+        precoders->scatter_re[i] = channel_rng_gaussian(&state) * 0.70710678f;
+        precoders->scatter_im[i] = channel_rng_gaussian(&state) * 0.70710678f;
+        precoders->rng[i] = state;
+    }
+}
+
+static inline void mu_mimo_free(MuMimoPrecoders *precoders) {
+    free(precoders->w_re);
+    free(precoders->w_im);
+    free(precoders->scatter_re);
+    free(precoders->scatter_im);
+    free(precoders->rng);
+}
+
+// Recomputes every precoder from the UE positions and advances the scattering by one CSI period
+static inline void mu_mimo_update(MuMimoPrecoders *precoders, const ChannelModel *channel) {
+    int antennas = precoders->num_antennas;
+    float los = sqrtf(1.0f - MU_MIMO_SCATTER_POWER);
+    float nlos = sqrtf(MU_MIMO_SCATTER_POWER);
+
+    for (int ue = 0; ue < precoders->num_ues; ue++) {
+        size_t row = (size_t)ue * precoders->stride;
+        float *restrict w_re = precoders->w_re + row;
+        float *restrict w_im = precoders->w_im + row;
+        float *restrict scatter_re = precoders->scatter_re + row;
+        float *restrict scatter_im = precoders->scatter_im + row;
+        uint32_t *restrict rng = precoders->rng + row;
+
+        // Half-wavelength spacing: phase step pi * sin(angle) between neighbouring elements
+        float distance = sqrtf(channel->pos_x[ue] * channel->pos_x[ue] + channel->pos_y[ue] * channel->pos_y[ue]);
+        float phase_step = 3.14159265f * channel->pos_y[ue] / fmaxf(distance, 1.0f);
+        float rho = powf(channel->fading_rho[ue], MU_MIMO_CSI_PERIOD);
+        float innov = sqrtf((1.0f - rho * rho) * 0.5f);
+
+        // Steering vector e^(-j * phase_step * a), by rotating one element to the next
+        float step_re = cosf(phase_step);
+        float step_im = sinf(phase_step);
+        float re = los, im = 0;
+        for (int a = 0; a < antennas; a++) {
+            w_re[a] = re;
+            w_im[a] = im;
+            float next_re = re * step_re + im * step_im;
+            im = im * step_re - re * step_im;
+            re = next_re;
+        }
+
+        for (int a = 0; a < antennas; a++) {
+            uint32_t state = rng[a];
+            float g0 = channel_rng_gaussian(&state);
+            float g1 = channel_rng_gaussian(&state);
+            rng[a] = state;
+            float s_re = rho * scatter_re[a] + innov * g0;
+            float s_im = rho * scatter_im[a] + innov * g1;
+            scatter_re[a] = s_re;
+            scatter_im[a] = s_im;
+            w_re[a] += nlos * s_re;
+            w_im[a] += nlos * s_im;
+        }
+
+        float norm = 0;
+        for (int a = 0; a < antennas; a++) {
+            norm += w_re[a] * w_re[a] + w_im[a] * w_im[a];
+        }
+        float scale = 1.0f / sqrtf(norm + 1e-12f);
+        for (int a = 0; a < antennas; a++) {
+            w_re[a] *= scale;
+            w_im[a] *= scale;
+        }
+    }
+}
+
+// |w_a^H w_b|^2 for unit-norm precoders, in [0, 1]
+static inline float mu_mimo_correlation(const MuMimoPrecoders *precoders, int a, int b) {
+    const float *restrict a_re = precoders->w_re + (size_t)a * precoders->stride;
+    const float *restrict a_im = precoders->w_im + (size_t)a * precoders->stride;
+    const float *restrict b_re = precoders->w_re + (size_t)b * precoders->stride;
+    const float *restrict b_im = precoders->w_im + (size_t)b * precoders->stride;
+    float dot_re = 0, dot_im = 0;
+    for (int k = 0; k < precoders->num_antennas; k++) {
+        dot_re += a_re[k] * b_re[k] + a_im[k] * b_im[k];
+        dot_im += a_re[k] * b_im[k] - a_im[k] * b_re[k];
+    }
+    return dot_re * dot_re + dot_im * dot_im;
+}
+
+// Post-pairing SINR of every member of a group, from single-user SINRs and pairwise correlations
+static inline void mu_mimo_group_sinr(int size, const float *sinr_su, const float corr[][MU_MIMO_MAX_LAYERS],
+                                      float array_gain, float *sinr) {
+    float share = array_gain / size;
+    for (int i = 0; i < size; i++) {
+        float leakage = 0;
+        for (int j = 0; j < size; j++) {
+            leakage += j != i ? corr[i][j] : 0.0f;
+        }
+        float signal = share * sinr_su[i];
+        sinr[i] = signal / (1.0f + signal * leakage);
+    }
+}
+
+// Weighted sum of log2(1 + sinr); the weight is the scheduler's priority (e.g. 1 / average rate for PF)
+static inline float mu_mimo_group_utility(int size, const float *weight, const float *sinr) {
+    float utility = 0;
+    for (int i = 0; i < size; i++) {
+        utility += weight[i] * log2f(1.0f + sinr[i]);
+    }
+    return utility;
+}
+
+// Greedy pairing for one RBG. candidates[] are UE indices in descending priority; the first
+// always gets the RBG, each next one joins if it is no more correlated than max_correlation
+// with every member and raises the group's weighted sum rate. sinr_linear[] and weight[] are
+// indexed by UE. Fills group[] and group_sinr[] (linear) and returns the group size.
+static inline int mu_mimo_pair(const MuMimoPrecoders *precoders, const float *sinr_linear, const float *weight,
+                               const int *candidates, int num_candidates, int layers, float max_correlation,
+                               int *group, float *group_sinr) {
+    float corr[MU_MIMO_MAX_LAYERS][MU_MIMO_MAX_LAYERS];
+    float member_sinr[MU_MIMO_MAX_LAYERS];
+    float member_weight[MU_MIMO_MAX_LAYERS];
+    float trial_sinr[MU_MIMO_MAX_LAYERS];
+    float array_gain = (float)precoders->num_antennas;
+    if (num_candidates == 0) {
+        return 0;
+    }
+    if (layers > MU_MIMO_MAX_LAYERS) {
+        layers = MU_MIMO_MAX_LAYERS;
+    }
+
+    int size = 1;
+    group[0] = candidates[0];
+    corr[0][0] = 1.0f;
+    member_sinr[0] = sinr_linear[group[0]];
+    member_weight[0] = weight[group[0]];
+    mu_mimo_group_sinr(1, member_sinr, corr, array_gain, group_sinr);
+    float best = mu_mimo_group_utility(1, member_weight, group_sinr);
+
+    for (int c = 1; c < num_candidates && size < layers; c++) {
+        int ue = candidates[c];
+        int orthogonal = 1;
+        for (int m = 0; m < size; m++) {
+            float rho = mu_mimo_correlation(precoders, ue, group[m]);
+            if (rho > max_correlation) {
+                orthogonal = 0;
+                break;
+            }
+            corr[size][m] = rho;
+            corr[m][size] = rho;
+        }
+        if (!orthogonal) {
+            continue;
+        }
+
+        corr[size][size] = 1.0f;
+        member_sinr[size] = sinr_linear[ue];
+        member_weight[size] = weight[ue];
+        mu_mimo_group_sinr(size + 1, member_sinr, corr, array_gain, trial_sinr);
+        float utility = mu_mimo_group_utility(size + 1, member_weight, trial_sinr);
+        if (utility > best) {
+            best = utility;
+            group[size++] = ue;
+            for (int m = 0; m < size; m++) {
+                group_sinr[m] = trial_sinr[m];
+            }
+        }
+    }
+    return size;
+}
+
+// Maps a linear SINR to the MCS the UE can sustain, with the same CQI table as the channel model
+static inline int mu_mimo_mcs(float sinr_linear) {
+    float sinr_db = 4.3429448f * logf(sinr_linear + 1e-12f);
+    int q = 0;
+    for (int k = 0; k < CQI_COUNT - 1; k++) {
+        q += sinr_db >= cqi_sinr_threshold_db[k];
+    }
+    return cqi_to_mcs[q];
+}
+
+#endif
@@ -0,0 +1,476 @@
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scenario.h"
+#include "channel_model.h"
+
+// Multi-cell proportional fair scheduling with inter-cell interference on a hexagonal layout
+// (7, 19 or 37 sites, optionally three sectors per site). Each UE's SINR on a subband counts
+// the interference from every other cell that used that subband in the previous TTI, so one
+// cell's scheduling decisions shape its neighbours' MCS a TTI later.
+//
+// Cells are split over `workers` threads. RB occupancy is double-buffered: in TTI t every
+// cell reads the neighbours' map from t - 1 and writes its own map for t into the other
+// buffer, so the only synchronization is one barrier per TTI and no shared state is locked.
+// Each cell's occupancy row has its own cache lines, each Cell is cache-line aligned, and each
+// cell's block of per-UE state is padded to whole cache lines, so workers never write the same
+// line. Per-TTI scratch is
+// allocated per worker at startup. Results do not depend on the number of workers.
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+#define PF_AVERAGING_TTIS 100.0f
+#define MULTI_CELL_ISD_M 500.0f
+#define MULTI_CELL_SUBBAND_RBS 8
+#define MULTI_CELL_NOISE_PER_RB_DBM -112.4f     // -174 dBm/Hz + 10log10(180 kHz) + 9 dB noise figure
+#define MULTI_CELL_SECTOR_BEAMWIDTH_DEG 65.0f
+#define MULTI_CELL_FRONT_TO_BACK_DB 20.0f
+#define MULTI_CELL_FADING_RHO 0.99f
+#define MULTI_CELL_PACKET_BYTES 1500
+#define MULTI_CELL_BARRIER_SPINS 2000
+
+typedef struct {
+    atomic_int waiting;
+    atomic_int generation;
+    int parties;
+} SpinBarrier;
+
+// Aligned so cells owned by different workers never share a cache line
+typedef struct {
+    _Alignas(64) float x;
+    float y;
+    int sectored;
+    float boresight;        // radians, sectored cells only
+    uint32_t rng;
+    long long bytes;
+    long long occupied_subbands;
+    double sinr_db_sum;
+    long long grants;
+} Cell;
+
+typedef struct {
+    int index;
+    int first_cell;
+    int last_cell;
+    pthread_t thread;
+    // Scratch for schedule_cell, sized from the scenario
+    float *interference;    // [subband_stride]
+    int *rate;              // [k * num_subbands + subband]
+    float *sinr_db;         // [k * num_subbands + subband]
+    int *remaining;         // [users_per_cell]
+    int *given;             // [users_per_cell]
+} Worker;
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
+int num_cells;
+int users_per_cell;
+int ue_stride;              // UE slots per cell in the per-UE arrays, a multiple of a cache line
+int num_subbands;
+int subband_stride;         // floats per occupancy row, a multiple of a cache line
+Cell *cells;
+float *occupancy[2];        // [cell * subband_stride + subband], 1 if the cell used the subband
+float arrival_probability;
+
+// Per UE, UEs of cell c are c * ue_stride .. c * ue_stride + users_per_cell - 1; the slots
+// after them up to the next cell are padding
+float *serving_gain;        // linear SNR of the serving link without fading
+float *interferer_gain;     // [ue * num_cells + cell], 0 for the serving cell
+float *fading_re;           // [ue * num_subbands + subband]
+float *fading_im;
+float *average_rate;
+int *buffer;
+long long *ue_bytes;
+
+SpinBarrier tti_barrier;
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+double now_ns();
+int hex_layout(int sites, float *x, float *y);
+void place_cells();
+void drop_users(unsigned int seed);
+void schedule_cell(Worker *worker, int c, int tti);
+void *worker_thread(void *arg);
+int compare_floats(const void *a, const void *b);
+
+void *worker_alloc(size_t bytes) {
+    void *memory = malloc(bytes);
+    if (memory == NULL) {
+        perror("Failed to allocate worker scratch");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+static void spin_barrier_wait(SpinBarrier *barrier) {
+    int generation = atomic_load_explicit(&barrier->generation, memory_order_acquire);
+    if (atomic_fetch_add_explicit(&barrier->waiting, 1, memory_order_acq_rel) == barrier->parties - 1) {
+        atomic_store_explicit(&barrier->waiting, 0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&barrier->generation, 1, memory_order_release);
+        return;
+    }
+    int spins = 0;
+    while (atomic_load_explicit(&barrier->generation, memory_order_acquire) == generation) {
+        if (++spins > MULTI_CELL_BARRIER_SPINS) {
+            sched_yield();
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
+    generate_TBSArray(TBSArray);
+    unsigned int seed = scenario_seed(&scenario);
+
+    num_cells = scenario.cells;
+    users_per_cell = scenario.users;
+    ue_stride = (users_per_cell + 15) & ~15;
+    num_subbands = (scenario.resource_blocks + MULTI_CELL_SUBBAND_RBS - 1) / MULTI_CELL_SUBBAND_RBS;
+    subband_stride = (num_subbands + 15) & ~15;
+    int num_workers = scenario.workers < num_cells ? scenario.workers : num_cells;
+    arrival_probability = (float)(scenario.dl_kbps * 1000.0 / 8.0 * TTI_DURATION / MULTI_CELL_PACKET_BYTES);
+
+    cells = aligned_alloc(64, num_cells * sizeof(Cell));
+    memset(cells, 0, num_cells * sizeof(Cell));
+    place_cells();
+    for (int k = 0; k < 2; k++) {
+        occupancy[k] = aligned_alloc(64, (size_t)num_cells * subband_stride * sizeof(float));
+        memset(occupancy[k], 0, (size_t)num_cells * subband_stride * sizeof(float));
+    }
+    drop_users(seed);
+
+    printf("THIS IS MULTI-CELL PROPORTIONAL FAIR SCHEDULING (%d cells, %d UEs per cell, %d subbands of %d RBs, %d workers)\n",
+           num_cells, users_per_cell, num_subbands, MULTI_CELL_SUBBAND_RBS, num_workers);
+    if (scenario.dl_kbps > 0) {
+        printf("Offered load = %.0f kbps per UE\n", scenario.dl_kbps);
+    } else {
+        printf("Full buffer\n");
+    }
+
+    Worker workers[num_workers];
+    atomic_init(&tti_barrier.waiting, 0);
+    atomic_init(&tti_barrier.generation, 0);
+    tti_barrier.parties = num_workers;
+    for (int w = 0; w < num_workers; w++) {
+        workers[w].index = w;
+        workers[w].first_cell = num_cells * w / num_workers;
+        workers[w].last_cell = num_cells * (w + 1) / num_workers;
+        workers[w].interference = worker_alloc(subband_stride * sizeof(float));
+        workers[w].rate = worker_alloc((size_t)users_per_cell * num_subbands * sizeof(int));
+        workers[w].sinr_db = worker_alloc((size_t)users_per_cell * num_subbands * sizeof(float));
+        workers[w].remaining = worker_alloc(users_per_cell * sizeof(int));
+        workers[w].given = worker_alloc(users_per_cell * sizeof(int));
+    }
+
+    double start = now_ns();
+    for (int w = 1; w < num_workers; w++) {
+        if (pthread_create(&workers[w].thread, NULL, worker_thread, &workers[w]) != 0) {
+            perror("Failed to start cell worker");
+            exit(EXIT_FAILURE);
+        }
+    }
+    worker_thread(&workers[0]);
+    for (int w = 1; w < num_workers; w++) {
+        pthread_join(workers[w].thread, NULL);
+    }
+    double elapsed_ns = now_ns() - start;
+
+    int num_users = num_cells * users_per_cell;
+    double seconds = scenario.ttis * TTI_DURATION;
+    long long bytes = 0, occupied = 0, grants = 0;
+    double sinr_sum = 0;
+    for (int c = 0; c < num_cells; c++) {
+        bytes += cells[c].bytes;
+        occupied += cells[c].occupied_subbands;
+        grants += cells[c].grants;
+        sinr_sum += cells[c].sinr_db_sum;
+    }
+    float *ue_mbps = malloc(num_users * sizeof(float));
+    for (int c = 0; c < num_cells; c++) {
+        for (int k = 0; k < users_per_cell; k++) {
+            ue_mbps[c * users_per_cell + k] = (float)(ue_bytes[(size_t)c * ue_stride + k] * 8 / 1000000.0 / seconds);
+        }
+    }
+    qsort(ue_mbps, num_users, sizeof(float), compare_floats);
+
+    printf("\nAverage cell throughput = %.3f Mbps\n", bytes * 8 / 1000000.0 / seconds / num_cells);
+    printf("UE throughput: median = %.3f Mbps, 5th percentile = %.3f Mbps\n", ue_mbps[num_users / 2], ue_mbps[num_users / 20]);
+    printf("Subband occupancy = %.1f%%, average SINR of granted subbands = %.2f dB\n",
+           100.0 * occupied / ((double)scenario.ttis * num_cells * num_subbands), grants > 0 ? sinr_sum / grants : 0);
+    printf("Simulated %d TTIs in %.3f s (%.0f ns per TTI, %.0f ns per cell-TTI)\n", scenario.ttis, elapsed_ns / 1e9,
+           elapsed_ns / scenario.ttis, elapsed_ns / scenario.ttis / num_cells);
+
+    for (int w = 0; w < num_workers; w++) {
+        free(workers[w].interference);
+        free(workers[w].rate);
+        free(workers[w].sinr_db);
+        free(workers[w].remaining);
+        free(workers[w].given);
+    }
+    free(ue_mbps);
+    free(cells);
+    free(occupancy[0]);
+    free(occupancy[1]);
+    free(serving_gain);
+    free(interferer_gain);
+    free(fading_re);
+    free(fading_im);
+    free(average_rate);
+    free(buffer);
+    free(ue_bytes);
+    return 0;
+}
+
+double now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+int compare_floats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Site centres of a hexagonal grid, centre first and then ring by ring; returns the count
+int hex_layout(int sites, float *x, float *y) {
+    int count = 0;
+    for (int ring = 0; count < sites; ring++) {
+        for (int q = -ring; q <= ring; q++) {
+            for (int r = -ring; r <= ring; r++) {
+                int s = -q - r;
+                int distance = abs(q) > abs(r) ? (abs(q) > abs(s) ? abs(q) : abs(s)) : (abs(r) > abs(s) ? abs(r) : abs(s));
+                if (distance != ring || count == sites) {
+                    continue;
+                }
+                x[count] = MULTI_CELL_ISD_M * (q + r * 0.5f);
+                y[count] = MULTI_CELL_ISD_M * r * 0.8660254f;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// cells is a hexagonal site count (1, 7, 19, 37) or three times one for sectored sites
+void place_cells() {
+    static const int hex_sites[] = {1, 7, 19, 37};
+    int sites = 0, sectors = 0;
+    for (int k = 0; k < 4; k++) {
+        if (num_cells == hex_sites[k]) {
+            sites = hex_sites[k];
+            sectors = 1;
+        } else if (num_cells == 3 * hex_sites[k]) {
+            sites = hex_sites[k];
+            sectors = 3;
+        }
+    }
+    if (sites == 0) {
+        fprintf(stderr, "cells must be 1, 7, 19 or 37 sites, or three sectors each (3, 21, 57, 111)\n");
+        exit(EXIT_FAILURE);
+    }
+
+    float x[37], y[37];
+    hex_layout(sites, x, y);
+    for (int site = 0; site < sites; site++) {
+        for (int sector = 0; sector < sectors; sector++) {
+            Cell *cell = &cells[site * sectors + sector];
+            cell->x = x[site];
+            cell->y = y[site];
+            cell->sectored = sectors == 3;
+            cell->boresight = sector * 2.0943951f + 0.5235988f;
+        }
+    }
+}
+
+// Antenna gain in dB towards (dx, dy), the 3GPP horizontal sector pattern
+static float antenna_gain_db(const Cell *cell, float dx, float dy) {
+    if (!cell->sectored) {
+        return 0.0f;
+    }
+    float angle = atan2f(dy, dx) - cell->boresight;
+    angle = remainderf(angle, 6.2831853f) * 57.29578f;
+    float attenuation = 12.0f * (angle / MULTI_CELL_SECTOR_BEAMWIDTH_DEG) * (angle / MULTI_CELL_SECTOR_BEAMWIDTH_DEG);
+    return -fminf(attenuation, MULTI_CELL_FRONT_TO_BACK_DB);
+}
+
+// Static UE positions inside each cell's coverage, log-normal shadowing on every link
+void drop_users(unsigned int seed) {
+    size_t num_slots = (size_t)num_cells * ue_stride;
+    serving_gain = channel_alloc(num_slots, sizeof(float));
+    interferer_gain = channel_alloc(num_slots * num_cells, sizeof(float));
+    fading_re = channel_alloc(num_slots * num_subbands, sizeof(float));
+    fading_im = channel_alloc(num_slots * num_subbands, sizeof(float));
+    average_rate = channel_alloc(num_slots, sizeof(float));
+    buffer = channel_alloc(num_slots, sizeof(int));
+    ue_bytes = channel_alloc(num_slots, sizeof(long long));
+    memset(buffer, 0, num_slots * sizeof(int));
+    memset(ue_bytes, 0, num_slots * sizeof(long long));
+
+    float tx_per_rb_dbm = CHANNEL_TX_POWER_DBM - 10.0f * log10f((float)scenario.resource_blocks);
+    float cell_radius = MULTI_CELL_ISD_M / 1.7320508f;
+    for (int c = 0; c < num_cells; c++) {
+        Cell *cell = &cells[c];
+        uint32_t state = (seed ^ 0x7F4A7C15u) + (uint32_t)c * 0x9E3779B9u;
+        cell->rng = state != 0 ? state : 1;
+
+        for (int k = 0; k < users_per_cell; k++) {
+            int ue = c * ue_stride + k;
+            float radius = fmaxf(sqrtf(channel_rng_uniform(&cell->rng)) * cell_radius, CHANNEL_MIN_DISTANCE_M);
+            float angle = !cell->sectored ? channel_rng_uniform(&cell->rng) * 6.2831853f
+                                          : cell->boresight + (channel_rng_uniform(&cell->rng) - 0.5f) * 2.0943951f;
+            float ue_x = cell->x + radius * cosf(angle);
+            float ue_y = cell->y + radius * sinf(angle);
+
+            for (int other = 0; other < num_cells; other++) {
+                float dx = ue_x - cells[other].x;
+                float dy = ue_y - cells[other].y;
+                float distance = fmaxf(sqrtf(dx * dx + dy * dy), CHANNEL_MIN_DISTANCE_M);
+                float pathloss_db = 128.1f + 16.329f * logf(distance * 0.001f);
+                float shadowing_db = CHANNEL_SHADOWING_STD_DB * channel_rng_gaussian(&cell->rng);
+                float snr_db = tx_per_rb_dbm - pathloss_db - shadowing_db + antenna_gain_db(&cells[other], dx, dy) -
+                               MULTI_CELL_NOISE_PER_RB_DBM;
+                float gain = powf(10.0f, snr_db / 10.0f);
+                interferer_gain[(size_t)ue * num_cells + other] = other == c ? 0.0f : gain;
+                if (other == c) {
+                    serving_gain[ue] = gain;
+                }
+            }
+            for (int b = 0; b < num_subbands; b++) {
+                fading_re[(size_t)ue * num_subbands + b] = channel_rng_gaussian(&cell->rng) * 0.70710678f;
+                fading_im[(size_t)ue * num_subbands + b] = channel_rng_gaussian(&cell->rng) * 0.70710678f;
+            }
+            average_rate[ue] = 1.0f;
+        }
+    }
+}
+
+// One TTI of one cell: SINR from last TTI's neighbour occupancy, PF per subband. The cell's
+// counters are summed in locals and stored once at the end.
+void schedule_cell(Worker *worker, int c, int tti) {
+    Cell *cell = &cells[c];
+    const float *previous = occupancy[(tti + 1) & 1];
+    float *current = occupancy[tti & 1] + (size_t)c * subband_stride;
+    int first_ue = c * ue_stride;
+    float fading_innov = sqrtf((1.0f - MULTI_CELL_FADING_RHO * MULTI_CELL_FADING_RHO) * 0.5f);
+    float *restrict interference = worker->interference;
+    int *restrict rate = worker->rate;
+    float *restrict sinr_db = worker->sinr_db;
+    int *restrict remaining = worker->remaining;
+    int *restrict given = worker->given;
+    long long bytes_sum = 0, occupied_subbands = 0, grants = 0;
+    double sinr_db_sum = 0;
+
+    for (int k = 0; k < users_per_cell; k++) {
+        int ue = first_ue + k;
+        if (arrival_probability > 0 && channel_rng_uniform(&cell->rng) < arrival_probability) {
+            buffer[ue] += MULTI_CELL_PACKET_BYTES;
+        }
+        remaining[k] = arrival_probability > 0 ? buffer[ue] : -1;
+
+        for (int b = 0; b < subband_stride; b++) {
+            interference[b] = 1.0f;
+        }
+        const float *gains = interferer_gain + (size_t)ue * num_cells;
+        for (int other = 0; other < num_cells; other++) {
+            float gain = gains[other];
+            const float *row = previous + (size_t)other * subband_stride;
+            for (int b = 0; b < subband_stride; b++) {
+                interference[b] += gain * row[b];
+            }
+        }
+
+        float *re = fading_re + (size_t)ue * num_subbands;
+        float *im = fading_im + (size_t)ue * num_subbands;
+        for (int b = 0; b < num_subbands; b++) {
+            re[b] = MULTI_CELL_FADING_RHO * re[b] + fading_innov * channel_rng_gaussian(&cell->rng);
+            im[b] = MULTI_CELL_FADING_RHO * im[b] + fading_innov * channel_rng_gaussian(&cell->rng);
+            float sinr = serving_gain[ue] * (re[b] * re[b] + im[b] * im[b]) / interference[b];
+            float db = 10.0f * log10f(sinr + 1e-12f);
+            int q = 0;
+            for (int t = 0; t < CQI_COUNT - 1; t++) {
+                q += db >= cqi_sinr_threshold_db[t];
+            }
+            int blocks = b == num_subbands - 1 ? scenario.resource_blocks - b * MULTI_CELL_SUBBAND_RBS : MULTI_CELL_SUBBAND_RBS;
+            rate[(size_t)k * num_subbands + b] = q > 0 ? TBSArray[cqi_to_mcs[q]][blocks] : 0;
+            sinr_db[(size_t)k * num_subbands + b] = db;
+        }
+    }
+
+    for (int k = 0; k < users_per_cell; k++) {
+        given[k] = 0;
+    }
+    for (int b = 0; b < num_subbands; b++) {
+        int best = -1;
+        float best_key = 0;
+        for (int k = 0; k < users_per_cell; k++) {
+            int k_rate = rate[(size_t)k * num_subbands + b];
+            if (k_rate == 0 || remaining[k] == 0) {
+                continue;
+            }
+            float key = k_rate / (average_rate[first_ue + k] + given[k]);
+            if (key > best_key) {
+                best_key = key;
+                best = k;
+            }
+        }
+        current[b] = best >= 0 ? 1.0f : 0.0f;
+        if (best < 0) {
+            continue;
+        }
+        int bytes = rate[(size_t)best * num_subbands + b];
+        if (remaining[best] > 0) {
+            bytes = bytes < remaining[best] ? bytes : remaining[best];
+            remaining[best] -= bytes;
+        }
+        given[best] += bytes;
+        occupied_subbands++;
+        grants++;
+        sinr_db_sum += sinr_db[(size_t)best * num_subbands + b];
+    }
+
+    for (int k = 0; k < users_per_cell; k++) {
+        int ue = first_ue + k;
+        average_rate[ue] = average_rate[ue] * (1.0f - 1.0f / PF_AVERAGING_TTIS) + given[k] / PF_AVERAGING_TTIS;
+        ue_bytes[ue] += given[k];
+        bytes_sum += given[k];
+        if (arrival_probability > 0) {
+            buffer[ue] -= given[k];
+        }
+    }
+
+    cell->bytes += bytes_sum;
+    cell->occupied_subbands += occupied_subbands;
+    cell->grants += grants;
+    cell->sinr_db_sum += sinr_db_sum;
+}
+
+void *worker_thread(void *arg) {
+    Worker *worker = (Worker *)arg;
+    for (int tti = 0; tti < scenario.ttis; tti++) {
+        for (int c = worker->first_cell; c < worker->last_cell; c++) {
+            schedule_cell(worker, c, tti);
+        }
+        spin_barrier_wait(&tti_barrier);
+    }
+    return NULL;
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
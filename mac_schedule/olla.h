@@ -0,0 +1,97 @@
+#ifndef OLLA_H
+#define OLLA_H
+
+#include <math.h>
+#include <stdlib.h>
+
+// Outer-loop link adaptation (OLLA).
+// Each UE keeps a SINR offset that is pushed up on NACK and pulled down on ACK,
+// so that the long-run block error rate converges to OLLA_TARGET_BLER.
+// MCS selection and the BLER draw are both table lookups, so a per-UE update is O(1).
+
+#ifndef MAX_MCS_INDEX
+#define MAX_MCS_INDEX 28
+#endif
+
+#define OLLA_TARGET_BLER 0.1
+#define OLLA_STEP_UP_DB 0.5
+#define OLLA_STEP_DOWN_DB (OLLA_STEP_UP_DB * OLLA_TARGET_BLER / (1.0 - OLLA_TARGET_BLER))
+#define OLLA_MAX_OFFSET_DB 10.0
+
+#define OLLA_SINR_MIN_DB -20.0
+#define OLLA_SINR_MAX_DB 40.0
+#define OLLA_SINR_STEP_DB 0.1
+#define OLLA_TABLE_SIZE 601          // (OLLA_SINR_MAX_DB - OLLA_SINR_MIN_DB) / OLLA_SINR_STEP_DB + 1
+
+#define OLLA_MARGIN_MIN_DB -20.0
+#define OLLA_MARGIN_MAX_DB 20.0
+#define OLLA_MARGIN_TABLE_SIZE 401   // (OLLA_MARGIN_MAX_DB - OLLA_MARGIN_MIN_DB) / OLLA_SINR_STEP_DB + 1
+
+// SINR at which MCS m reaches the target BLER: OLLA_MCS_SINR_BASE_DB + m * OLLA_MCS_SINR_STEP_DB
+#define OLLA_MCS_SINR_BASE_DB -6.0
+#define OLLA_MCS_SINR_STEP_DB 1.0
+#define OLLA_BLER_SLOPE 1.5
+
+static int olla_mcs_table[OLLA_TABLE_SIZE];
+static int olla_bler_table[OLLA_MARGIN_TABLE_SIZE];  // BLER scaled to RAND_MAX
+
+static inline double olla_mcs_sinr_db(int mcs) {
+    return OLLA_MCS_SINR_BASE_DB + mcs * OLLA_MCS_SINR_STEP_DB;
+}
+
+static inline int olla_sinr_index(double sinr_db, double min_db, int size) {
+    int index = (int)((sinr_db - min_db) / OLLA_SINR_STEP_DB + 0.5);
+    if (index < 0) {
+        return 0;
+    }
+    if (index >= size) {
+        return size - 1;
+    }
+    return index;
+}
+
+static inline void olla_init_tables() {
+    // Highest MCS whose threshold does not exceed the effective SINR
+    for (int i = 0; i < OLLA_TABLE_SIZE; i++) {
+        double sinr_db = OLLA_SINR_MIN_DB + i * OLLA_SINR_STEP_DB;
+        int mcs = 0;
+        while (mcs < MAX_MCS_INDEX && olla_mcs_sinr_db(mcs + 1) <= sinr_db + 1e-9) {
+            mcs++;
+        }
+        olla_mcs_table[i] = mcs;
+    }
+
+    // Logistic BLER curve, equal to OLLA_TARGET_BLER at zero margin
+    double bias = log((1.0 - OLLA_TARGET_BLER) / OLLA_TARGET_BLER);
+    for (int i = 0; i < OLLA_MARGIN_TABLE_SIZE; i++) {
+        double margin_db = OLLA_MARGIN_MIN_DB + i * OLLA_SINR_STEP_DB;
+        double bler = 1.0 / (1.0 + exp(OLLA_BLER_SLOPE * margin_db + bias));
+        olla_bler_table[i] = (int)(bler * RAND_MAX);
+    }
+}
+
+static inline int olla_select_mcs(double reported_sinr_db, double offset_db) {
+    return olla_mcs_table[olla_sinr_index(reported_sinr_db - offset_db, OLLA_SINR_MIN_DB, OLLA_TABLE_SIZE)];
+}
+
+// Draws the HARQ outcome of a transport block sent at mcs over a channel at sinr_db
+static inline int olla_harq_ack(double sinr_db, int mcs) {
+    double margin_db = sinr_db - olla_mcs_sinr_db(mcs);
+    return rand() >= olla_bler_table[olla_sinr_index(margin_db, OLLA_MARGIN_MIN_DB, OLLA_MARGIN_TABLE_SIZE)];
+}
+
+static inline void olla_update(double *offset_db, int ack) {
+    if (ack) {
+        *offset_db -= OLLA_STEP_DOWN_DB;
+        if (*offset_db < -OLLA_MAX_OFFSET_DB) {
+            *offset_db = -OLLA_MAX_OFFSET_DB;
+        }
+    } else {
+        *offset_db += OLLA_STEP_UP_DB;
+        if (*offset_db > OLLA_MAX_OFFSET_DB) {
+            *offset_db = OLLA_MAX_OFFSET_DB;
+        }
+    }
+}
+
+#endif
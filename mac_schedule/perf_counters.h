@@ -0,0 +1,175 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Optional hardware counters around scheduler calls (perf_event_open): cycles, instructions,
+// cache misses and branch misses, read as one group before and after each call and summed
+// per policy and per UE-count bucket (0, 1, 2-3, 4-7, ... powers of two).
+//
+// The counters follow the thread that called perf_counters_open, user space only, so open
+// them on the thread that runs the scheduler. Until then perf_begin and perf_end are a
+// single predictable branch; once open, each call costs two read() syscalls, so time
+// measurements should not be taken in the same pass.
+//
+// Events the CPU or kernel does not offer (virtual machines often have none) are reported
+// as "-"; perf_event_paranoid above 2 blocks them all.
+
+#define PERF_BUCKETS 24
+#define PERF_MAX_POLICIES 16
+#define PERF_POLICY_NAME 48
+
+enum { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES, PERF_EVENTS };
+
+static const uint64_t perf_event_configs[PERF_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+static const char *perf_event_names[PERF_EVENTS] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+typedef struct {
+    char name[PERF_POLICY_NAME];
+    long long calls[PERF_BUCKETS];
+    uint64_t counts[PERF_BUCKETS][PERF_EVENTS];
+} PerfPolicyStats;
+
+typedef struct {
+    int enabled;
+    int group_fd;
+    int num_open;
+    int fds[PERF_EVENTS];
+    int slot_event[PERF_EVENTS];    // event read into each slot of the group
+    uint64_t start[PERF_EVENTS + 1];
+    int num_policies;
+    PerfPolicyStats policies[PERF_MAX_POLICIES];
+} PerfCounters;
+
+// Returns 1 if at least one event could be opened; the others are left out of the group
+static inline int perf_counters_open(PerfCounters *perf) {
+    memset(perf, 0, sizeof(*perf));
+    perf->group_fd = -1;
+    for (int event = 0; event < PERF_EVENTS; event++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = perf_event_configs[event];
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.disabled = perf->group_fd < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, perf->group_fd, 0);
+        if (fd < 0) {
+            fprintf(stderr, "perf counter %s unavailable: %s\n", perf_event_names[event], strerror(errno));
+            continue;
+        }
+        if (perf->group_fd < 0) {
+            perf->group_fd = fd;
+        }
+        perf->fds[perf->num_open] = fd;
+        perf->slot_event[perf->num_open++] = event;
+    }
+    if (perf->group_fd < 0) {
+        return 0;
+    }
+    ioctl(perf->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    perf->enabled = 1;
+    return 1;
+}
+
+// { nr, value per slot }
+static inline int perf_read(const PerfCounters *perf, uint64_t *values) {
+    ssize_t bytes = (perf->num_open + 1) * sizeof(uint64_t);
+    return read(perf->group_fd, values, bytes) == bytes;
+}
+
+static inline int perf_bucket(int num_ues) {
+    int bucket = 0;
+    while (num_ues > 0 && bucket < PERF_BUCKETS - 1) {
+        num_ues >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static inline PerfPolicyStats *perf_policy(PerfCounters *perf, const char *name) {
+    for (int p = 0; p < perf->num_policies; p++) {
+        if (strcmp(perf->policies[p].name, name) == 0) {
+            return &perf->policies[p];
+        }
+    }
+    if (perf->num_policies == PERF_MAX_POLICIES) {
+        return NULL;
+    }
+    PerfPolicyStats *stats = &perf->policies[perf->num_policies++];
+    snprintf(stats->name, sizeof(stats->name), "%s", name);
+    return stats;
+}
+
+static inline void perf_begin(PerfCounters *perf) {
+    if (perf->enabled && !perf_read(perf, perf->start)) {
+        perf->enabled = 0;
+    }
+}
+
+static inline void perf_end(PerfCounters *perf, const char *policy, int num_ues) {
+    if (!perf->enabled) {
+        return;
+    }
+    uint64_t end[PERF_EVENTS + 1];
+    PerfPolicyStats *stats = perf_policy(perf, policy);
+    if (!perf_read(perf, end) || stats == NULL) {
+        return;
+    }
+    int bucket = perf_bucket(num_ues);
+    stats->calls[bucket]++;
+    for (int slot = 0; slot < perf->num_open; slot++) {
+        stats->counts[bucket][perf->slot_event[slot]] += end[slot + 1] - perf->start[slot + 1];
+    }
+}
+
+// One line per policy and bucket with calls, per-call means and IPC
+static inline void perf_report(const PerfCounters *perf, FILE *out) {
+    int open[PERF_EVENTS] = {0};
+    for (int slot = 0; slot < perf->num_open; slot++) {
+        open[perf->slot_event[slot]] = 1;
+    }
+    for (int p = 0; p < perf->num_policies; p++) {
+        const PerfPolicyStats *stats = &perf->policies[p];
+        for (int bucket = 0; bucket < PERF_BUCKETS; bucket++) {
+            long long calls = stats->calls[bucket];
+            if (calls == 0) {
+                continue;
+            }
+            fprintf(out, "PERF policy=%s ues=%d-%d calls=%lld", stats->name, bucket ? 1 << (bucket - 1) : 0,
+                    bucket ? (1 << bucket) - 1 : 0, calls);
+            for (int event = 0; event < PERF_EVENTS; event++) {
+                if (open[event]) {
+                    fprintf(out, " %s=%.1f", perf_event_names[event], (double)stats->counts[bucket][event] / calls);
+                } else {
+                    fprintf(out, " %s=-", perf_event_names[event]);
+                }
+            }
+            if (open[PERF_CYCLES] && open[PERF_INSTRUCTIONS] && stats->counts[bucket][PERF_CYCLES] > 0) {
+                fprintf(out, " ipc=%.2f\n",
+                        (double)stats->counts[bucket][PERF_INSTRUCTIONS] / stats->counts[bucket][PERF_CYCLES]);
+            } else {
+                fprintf(out, " ipc=-\n");
+            }
+        }
+    }
+}
+
+static inline void perf_counters_close(PerfCounters *perf) {
+    for (int slot = 0; slot < perf->num_open; slot++) {
+        close(perf->fds[slot]);
+    }
+    perf->enabled = 0;
+}
+
+#endif
@@ -2,15 +2,15 @@
 #include <stdlib.h>
 #include <time.h>
 
-#define MAX_USERS 12
-#define USERS_PER_TTI 4
-#define MAX_TTIS 10000
+#include "scenario.h"
+#include "channel_model.h"
+
 #define MAX_MCS_INDEX 28
-#define MAX_RB 100
+#define MAX_RB SCENARIO_MAX_RB
 #define TTI_DURATION 0.001
-#define SCHEDULING_INTERVAL 40
 
 int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
 typedef struct {
     int user_id;
     int mcs_index;
@@ -21,24 +21,31 @@ typedef struct {
     int last_scheduled_tti;
 } User;
 
+// Scratch lists for proportional_scheduler, sized from the scenario once at startup
+User *delay_users;
+User *non_delay_users;
+
 void assign_resource_blocks(User *user, int num_blocks, int current_tti);
 void reset_resource_blocks(User *user);
 int compare_users(const void *a, const void *b);
 void proportional_scheduler(User users[], int num_users, int total_resource_blocks, int current_tti);
 void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
-void shuffle(int array[], int n);
-void generate_unique_random_mcs(User users[], int num_users);
+void update_channel_mcs(User users[], int num_users, ChannelModel *channel);
 
-int main() {
-    User users[MAX_USERS];
-    int total_resource_blocks;
-    int total_ttis = MAX_TTIS;
-    int num_users = MAX_USERS;
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
+
+    User *users = malloc(scenario.users * sizeof(User));
+    int total_resource_blocks = scenario.resource_blocks;
+    int total_ttis = scenario.ttis;
+    int num_users = scenario.users;
+    delay_users = malloc(num_users * sizeof(User));
+    non_delay_users = malloc(num_users * sizeof(User));
 
     generate_TBSArray(TBSArray);
 
     // Initialize users
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         users[i].user_id = i;
         users[i].total_resource_blocks = 0;
         users[i].current_resource_blocks = 0;
@@ -47,19 +54,31 @@ int main() {
         users[i].last_scheduled_tti = -1;
     }
 
-    srand(time(NULL));
+    ChannelModel channel;
+    channel_model_init(&channel, num_users, scenario_seed(&scenario));
+    ChannelTraceHeader trace_header;
+    FILE *trace = NULL;
+    if (scenario.channel_trace[0] != '\0') {
+        trace = channel_trace_open(scenario.channel_trace, num_users, total_ttis, &trace_header);
+    }
+
     printf("THIS IS PROPORTIONAL_FAIR WITH MCS CHANGED EVERY TTI ALGORITHM\n");
-    printf("Enter total number of resource blocks per TTI: ");
-    scanf("%d", &total_resource_blocks);
 
     // Perform maximum CI scheduling over multiple TTIs
     for (int tti = 0; tti < total_ttis; tti++) {
-        generate_unique_random_mcs(users, num_users);
-        proportional_scheduler(users, MAX_USERS, total_resource_blocks, tti);
+        // A trace replaces the model: its MCS row for the TTI goes where the model's would
+        if (trace == NULL) {
+            channel_model_step(&channel);
+        } else if (!channel_trace_read_tti(trace, &trace_header, channel.mcs)) {
+            fprintf(stderr, "Channel trace %s ended at TTI %d\n", scenario.channel_trace, tti);
+            exit(EXIT_FAILURE);
+        }
+        update_channel_mcs(users, num_users, &channel);
+        proportional_scheduler(users, num_users, total_resource_blocks, tti);
     }
 
     // Print resource blocks assigned to each user
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         printf("User %d: Total RBs over %d TTIs = %d, Average per TTI = %.2f, Times scheduled = %d, Average throughput = %.3f Mbps\n",
                users[i].user_id, total_ttis, users[i].total_resource_blocks,
                (float)users[i].total_resource_blocks / total_ttis, users[i].times_scheduled, (users[i].total_data_transmitted * 8 / 1000000)/(total_ttis*TTI_DURATION));
@@ -67,12 +86,19 @@ int main() {
 
     // Calculate total bytes transmitted by all users
     long long total_bytes_all_users = 0;
-    for (int i = 0; i < MAX_USERS; i++) {
+    for (int i = 0; i < num_users; i++) {
         total_bytes_all_users += users[i].total_data_transmitted;
     }
 
     printf("\nAverage throughput over the entire cell = %.3f Mbps\n", (total_bytes_all_users * 8 / 1000000)/(total_ttis*TTI_DURATION));
 
+    if (trace != NULL) {
+        fclose(trace);
+    }
+    channel_model_free(&channel);
+    free(users);
+    free(delay_users);
+    free(non_delay_users);
     return 0;
 }
 
@@ -95,14 +121,12 @@ int compare_users(const void *a, const void *b) {
 }
 
 void proportional_scheduler(User users[], int num_users, int total_resource_blocks, int current_tti) {
-    User delay_users[MAX_USERS];
-    User non_delay_users[MAX_USERS];
     int delay_count = 0;
     int non_delay_count = 0;
 
     // Separate delay and non-delay users
     for (int i = 0; i < num_users; i++) {
-        if (current_tti - users[i].last_scheduled_tti >= SCHEDULING_INTERVAL) {
+        if (current_tti - users[i].last_scheduled_tti >= scenario.scheduling_interval) {
             delay_users[delay_count++] = users[i];
         } else {
             non_delay_users[non_delay_count++] = users[i];
@@ -116,10 +140,10 @@ void proportional_scheduler(User users[], int num_users, int total_resource_bloc
     qsort(non_delay_users, non_delay_count, sizeof(User), compare_users);
 
     int users_scheduled = 0;
-    int blocks_per_user = total_resource_blocks / USERS_PER_TTI;
-    int remaining_blocks = total_resource_blocks % USERS_PER_TTI;
+    int blocks_per_user = total_resource_blocks / scenario.users_per_tti;
+    int remaining_blocks = total_resource_blocks % scenario.users_per_tti;
 
-    for (int i = 0; i < USERS_PER_TTI; i++) {
+    for (int i = 0; i < scenario.users_per_tti; i++) {
         if (i < delay_count) {
             reset_resource_blocks(&delay_users[i]);
         }
@@ -129,13 +153,13 @@ void proportional_scheduler(User users[], int num_users, int total_resource_bloc
     }
 
     // Schedule delay users first
-    for (int i = 0; i < delay_count && users_scheduled < USERS_PER_TTI; i++) {
+    for (int i = 0; i < delay_count && users_scheduled < scenario.users_per_tti; i++) {
         assign_resource_blocks(&delay_users[i], blocks_per_user, current_tti);
         users_scheduled++;
     }
 
     // Schedule non-delay users to fill remaining slots
-    for (int i = 0; i < non_delay_count && users_scheduled < USERS_PER_TTI; i++) {
+    for (int i = 0; i < non_delay_count && users_scheduled < scenario.users_per_tti; i++) {
         assign_resource_blocks(&non_delay_users[i], blocks_per_user, current_tti);
         users_scheduled++;
     }
@@ -175,22 +199,9 @@ void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
     }
 }
 
-void shuffle(int array[], int n) {
-    for (int i = n - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        int temp = array[i];
-        array[i] = array[j];
-        array[j] = temp;
-    }
-}
-
-void generate_unique_random_mcs(User users[], int num_users) {
-    int mcs_indices[MAX_MCS_INDEX + 1];
-    for (int i = 0; i <= MAX_MCS_INDEX; i++) {
-        mcs_indices[i] = i;
-    }
-    shuffle(mcs_indices, MAX_MCS_INDEX + 1);
+void update_channel_mcs(User users[], int num_users, ChannelModel *channel) {
+    // Users may have been reordered by the scheduler, so look the channel up by user_id
     for (int i = 0; i < num_users; i++) {
-        users[i].mcs_index = mcs_indices[i];
+        users[i].mcs_index = channel->mcs[users[i].user_id];
     }
 }
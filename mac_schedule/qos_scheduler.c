@@ -0,0 +1,371 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scenario.h"
+#include "channel_model.h"
+#include "indexed_heap.h"
+#include "scheduler_policy.h"
+
+// Two-level QoS scheduler over GBR, delay-critical and best-effort bearers.
+//
+// Level 1 serves guarantees in deadline order from an indexed min-heap:
+//   GBR bearers owe guaranteed minus delivered bytes; their deadline is the TTI at which that
+//   debt reaches QOS_GBR_WINDOW_TTIS worth of guaranteed rate.
+//   Delay-critical bearers queue fixed-size packets; their deadline is the head-of-line
+//   packet's arrival plus the delay budget. Packets past the budget are dropped.
+// Bearers whose deadline is within QOS_URGENCY_TTIS get exactly the RBs they need, up to
+// users_per_tti grants. Level 2 splits what is left by proportional fair among the other
+// backlogged bearers (GBR and best effort always have data). Level 1 costs O(grants log N)
+// per TTI and level 2 a single pass with a bounded top-K, so the TTI stays bounded at
+// thousands of bearers.
+
+#define MAX_MCS_INDEX 28
+#define MAX_RB SCENARIO_MAX_RB
+#define TTI_DURATION 0.001
+#define QOS_PACKET_BYTES 100
+#define QOS_QUEUE_SIZE 64           // packets per delay-critical bearer, power of two
+#define QOS_GBR_WINDOW_TTIS 20
+#define QOS_URGENCY_TTIS 2
+#define PF_AVERAGING_TTIS 100.0
+
+enum { QOS_GBR, QOS_DELAY, QOS_BE, QOS_CLASSES };
+
+static const char *qos_class_names[QOS_CLASSES] = {"GBR", "Delay-critical", "Best effort"};
+
+typedef struct {
+    int bearer_id;
+    int qos_class;
+    int mcs_index;
+    double rate_bytes;              // GBR: guaranteed, delay-critical: offered, per TTI
+    double debt_bytes;              // GBR: guaranteed minus delivered, as of debt_tti
+    int debt_tti;
+    int queue_head;
+    int queue_length;
+    int packet_arrival[QOS_QUEUE_SIZE];
+    double average_rate;
+    int total_resource_blocks;
+    int times_scheduled;
+    long long total_data_transmitted;
+    long long packets_arrived;
+    long long packets_delivered;
+    long long packets_dropped;
+} Bearer;
+
+int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1];
+Scenario scenario;
+// Per-TTI scratch, sized from the scenario once at startup
+int *served_this_tti;
+int *popped_bearers;
+int *selected_bearers;
+double *selected_keys;
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]);
+void generate_traffic(Bearer bearers[], int num_bearers, int current_tti);
+double gbr_debt(const Bearer *bearer, int current_tti);
+double required_bytes(const Bearer *bearer, int current_tti);
+void drop_expired_packets(Bearer *bearer, int current_tti);
+void update_deadline(IndexedHeap *heap, Bearer *bearer, int current_tti);
+int blocks_for_bytes(int mcs_index, double bytes, int max_blocks);
+void assign_resource_blocks(Bearer *bearer, int num_blocks, int current_tti);
+int guaranteed_scheduler(Bearer bearers[], IndexedHeap *heap, int *resource_blocks, int current_tti, int *num_popped);
+void proportional_fair_level(Bearer bearers[], int num_bearers, int resource_blocks, int max_grants, int current_tti);
+void qos_scheduler(Bearer bearers[], int num_bearers, IndexedHeap *heap, int total_resource_blocks, int current_tti);
+
+int main(int argc, char *argv[]) {
+    load_scenario(argc > 1 ? argv[1] : NULL, &scenario);
+
+    int num_bearers = scenario.users;
+    int total_ttis = scenario.ttis;
+    Bearer *bearers = calloc(num_bearers, sizeof(Bearer));
+    served_this_tti = calloc(num_bearers, sizeof(int));
+    popped_bearers = malloc(num_bearers * sizeof(int));
+    selected_bearers = malloc(scenario.users_per_tti * sizeof(int));
+    selected_keys = malloc(scenario.users_per_tti * sizeof(double));
+
+    generate_TBSArray(TBSArray);
+    srand(scenario_seed(&scenario));
+
+    // GBR bearers first, then delay-critical, then best effort
+    for (int i = 0; i < num_bearers; i++) {
+        bearers[i].bearer_id = i;
+        bearers[i].average_rate = 1.0;
+        if (i < scenario.gbr_bearers) {
+            bearers[i].qos_class = QOS_GBR;
+            bearers[i].rate_bytes = scenario.gbr_kbps * 1000 / 8 * TTI_DURATION;
+        } else if (i < scenario.gbr_bearers + scenario.delay_bearers) {
+            bearers[i].qos_class = QOS_DELAY;
+            bearers[i].rate_bytes = scenario.delay_kbps * 1000 / 8 * TTI_DURATION;
+        } else {
+            bearers[i].qos_class = QOS_BE;
+        }
+    }
+
+    IndexedHeap heap;
+    indexed_heap_init(&heap, num_bearers);
+    for (int i = 0; i < scenario.gbr_bearers; i++) {
+        update_deadline(&heap, &bearers[i], 0);
+    }
+
+    ChannelModel channel;
+    channel_model_init(&channel, num_bearers, scenario_seed(&scenario));
+
+    printf("THIS IS QOS TWO-LEVEL (DEADLINE HEAP + PROPORTIONAL FAIR) ALGORITHM\n");
+
+    struct timespec start, end;
+    double scheduler_seconds = 0;
+    for (int tti = 0; tti < total_ttis; tti++) {
+        channel_model_step(&channel);
+        for (int i = 0; i < num_bearers; i++) {
+            bearers[i].mcs_index = channel.mcs[i];
+        }
+        generate_traffic(bearers, num_bearers, tti);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        qos_scheduler(bearers, num_bearers, &heap, scenario.resource_blocks, tti);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        scheduler_seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    }
+
+    // Per-class summary
+    long long total_bytes_all_bearers = 0;
+    for (int c = 0; c < QOS_CLASSES; c++) {
+        int count = 0, satisfied = 0;
+        long long bytes = 0, arrived = 0, delivered = 0, dropped = 0;
+        for (int i = 0; i < num_bearers; i++) {
+            Bearer *bearer = &bearers[i];
+            if (bearer->qos_class != c) {
+                continue;
+            }
+            count++;
+            bytes += bearer->total_data_transmitted;
+            arrived += bearer->packets_arrived;
+            delivered += bearer->packets_delivered;
+            dropped += bearer->packets_dropped;
+            if (c == QOS_GBR && bearer->total_data_transmitted >= 0.95 * bearer->rate_bytes * total_ttis) {
+                satisfied++;
+            }
+        }
+        total_bytes_all_bearers += bytes;
+        if (count == 0) {
+            continue;
+        }
+        printf("%s: %d bearers, Average throughput per bearer = %.3f Mbps", qos_class_names[c], count,
+               (bytes * 8 / 1000000.0) / (total_ttis * TTI_DURATION) / count);
+        if (c == QOS_GBR) {
+            printf(", Bearers at >= 95%% of GBR = %d (%.1f%%)", satisfied, 100.0 * satisfied / count);
+        } else if (c == QOS_DELAY) {
+            printf(", Packets delivered = %lld, dropped past budget = %lld (%.3f%%)", delivered, dropped,
+                   arrived > 0 ? 100.0 * dropped / arrived : 0);
+        }
+        printf("\n");
+    }
+
+    printf("\nAverage throughput over the entire cell = %.3f Mbps\n", (total_bytes_all_bearers * 8 / 1000000.0) / (total_ttis * TTI_DURATION));
+    printf("Scheduler time = %.1f ns per TTI\n", scheduler_seconds * 1e9 / total_ttis);
+
+    channel_model_free(&channel);
+    indexed_heap_free(&heap);
+    free(bearers);
+    free(served_this_tti);
+    free(popped_bearers);
+    free(selected_bearers);
+    free(selected_keys);
+    return 0;
+}
+
+// Delay-critical bearers receive QOS_PACKET_BYTES packets at their offered rate
+void generate_traffic(Bearer bearers[], int num_bearers, int current_tti) {
+    for (int i = 0; i < num_bearers; i++) {
+        Bearer *bearer = &bearers[i];
+        if (bearer->qos_class != QOS_DELAY) {
+            continue;
+        }
+        if ((double)rand() / RAND_MAX >= bearer->rate_bytes / QOS_PACKET_BYTES) {
+            continue;
+        }
+        bearer->packets_arrived++;
+        if (bearer->queue_length == QOS_QUEUE_SIZE) {
+            bearer->packets_dropped++;
+            continue;
+        }
+        int tail = (bearer->queue_head + bearer->queue_length) & (QOS_QUEUE_SIZE - 1);
+        bearer->packet_arrival[tail] = current_tti;
+        bearer->queue_length++;
+    }
+}
+
+double gbr_debt(const Bearer *bearer, int current_tti) {
+    return bearer->debt_bytes + bearer->rate_bytes * (current_tti - bearer->debt_tti);
+}
+
+// Bytes the bearer needs now: GBR debt, or everything queued for delay-critical bearers
+double required_bytes(const Bearer *bearer, int current_tti) {
+    if (bearer->qos_class == QOS_GBR) {
+        return gbr_debt(bearer, current_tti);
+    }
+    return (double)bearer->queue_length * QOS_PACKET_BYTES;
+}
+
+void drop_expired_packets(Bearer *bearer, int current_tti) {
+    while (bearer->queue_length > 0 &&
+           current_tti - bearer->packet_arrival[bearer->queue_head] > scenario.delay_budget_ttis) {
+        bearer->queue_head = (bearer->queue_head + 1) & (QOS_QUEUE_SIZE - 1);
+        bearer->queue_length--;
+        bearer->packets_dropped++;
+    }
+}
+
+// Re-keys the bearer after its state changed; delay-critical bearers with nothing queued leave the heap
+void update_deadline(IndexedHeap *heap, Bearer *bearer, int current_tti) {
+    if (bearer->qos_class == QOS_GBR) {
+        double debt = gbr_debt(bearer, current_tti);
+        double window = bearer->rate_bytes * QOS_GBR_WINDOW_TTIS;
+        indexed_heap_update(heap, bearer->bearer_id, current_tti + (window - debt) / bearer->rate_bytes);
+    } else if (bearer->qos_class == QOS_DELAY && bearer->queue_length > 0) {
+        indexed_heap_update(heap, bearer->bearer_id,
+                            bearer->packet_arrival[bearer->queue_head] + scenario.delay_budget_ttis);
+    } else {
+        indexed_heap_remove(heap, bearer->bearer_id);
+    }
+}
+
+// Smallest allocation whose transport block carries bytes, capped at max_blocks
+int blocks_for_bytes(int mcs_index, double bytes, int max_blocks) {
+    int low = 1, high = max_blocks;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (TBSArray[mcs_index][mid] >= bytes) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+void assign_resource_blocks(Bearer *bearer, int num_blocks, int current_tti) {
+    int bytes = TBSArray[bearer->mcs_index][num_blocks];
+    bearer->total_resource_blocks += num_blocks;
+    bearer->times_scheduled += 1;
+    served_this_tti[bearer->bearer_id] = 1;
+
+    if (bearer->qos_class == QOS_GBR) {
+        // Credit for over-delivery is capped at one window, so a GBR bearer cannot bank service
+        double debt = gbr_debt(bearer, current_tti) - bytes;
+        double floor = -bearer->rate_bytes * QOS_GBR_WINDOW_TTIS;
+        bearer->debt_bytes = debt > floor ? debt : floor;
+        bearer->debt_tti = current_tti;
+    } else if (bearer->qos_class == QOS_DELAY) {
+        int packets = bytes / QOS_PACKET_BYTES;
+        if (packets > bearer->queue_length) {
+            packets = bearer->queue_length;
+        }
+        bearer->queue_head = (bearer->queue_head + packets) & (QOS_QUEUE_SIZE - 1);
+        bearer->queue_length -= packets;
+        bearer->packets_delivered += packets;
+        bytes = packets * QOS_PACKET_BYTES;
+    }
+    bearer->total_data_transmitted += bytes;
+    bearer->average_rate += bytes / PF_AVERAGING_TTIS;
+}
+
+// Level 1: serves bearers in deadline order while their deadline is close. Returns grants made
+// and leaves every bearer taken off the heap in popped_bearers[0..num_popped)
+int guaranteed_scheduler(Bearer bearers[], IndexedHeap *heap, int *resource_blocks, int current_tti, int *num_popped) {
+    int grants = 0;
+    *num_popped = 0;
+    while (heap->size > 0 && grants < scenario.users_per_tti && *resource_blocks > 0 &&
+           indexed_heap_top_key(heap) <= current_tti + QOS_URGENCY_TTIS) {
+        Bearer *bearer = &bearers[indexed_heap_top(heap)];
+        indexed_heap_remove(heap, bearer->bearer_id);
+        popped_bearers[(*num_popped)++] = bearer->bearer_id;
+
+        if (bearer->qos_class == QOS_DELAY) {
+            drop_expired_packets(bearer, current_tti);
+        }
+        double bytes = required_bytes(bearer, current_tti);
+        if (bytes <= 0) {
+            continue;
+        }
+        int blocks = blocks_for_bytes(bearer->mcs_index, bytes, *resource_blocks);
+        assign_resource_blocks(bearer, blocks, current_tti);
+        *resource_blocks -= blocks;
+        grants++;
+    }
+    return grants;
+}
+
+// Level 2: best PF metrics among backlogged bearers not served by level 1 share the remaining RBs
+void proportional_fair_level(Bearer bearers[], int num_bearers, int resource_blocks, int max_grants, int current_tti) {
+    if (max_grants <= 0 || resource_blocks <= 0) {
+        return;
+    }
+    int *selected = selected_bearers;
+    double *keys = selected_keys;
+    int found = 0;
+    for (int i = 0; i < num_bearers; i++) {
+        Bearer *bearer = &bearers[i];
+        if (served_this_tti[i] || (bearer->qos_class == QOS_DELAY && bearer->queue_length == 0)) {
+            continue;
+        }
+        double key = TBSArray[bearer->mcs_index][1] / bearer->average_rate;
+        scheduler_top_k_double(key, i, max_grants, &found, keys, selected);
+    }
+    if (found == 0) {
+        return;
+    }
+
+    int blocks_per_bearer = resource_blocks / found;
+    int remaining_blocks = resource_blocks % found;
+    for (int i = 0; i < found; i++) {
+        int blocks = blocks_per_bearer + (i < remaining_blocks ? 1 : 0);
+        if (blocks > 0) {
+            assign_resource_blocks(&bearers[selected[i]], blocks, current_tti);
+        }
+    }
+}
+
+void qos_scheduler(Bearer bearers[], int num_bearers, IndexedHeap *heap, int total_resource_blocks, int current_tti) {
+    int resource_blocks = total_resource_blocks;
+    int num_popped;
+
+    // Average rates decay every TTI; assign_resource_blocks adds this TTI's bytes
+    for (int i = 0; i < num_bearers; i++) {
+        bearers[i].average_rate *= 1.0 - 1.0 / PF_AVERAGING_TTIS;
+    }
+
+    int grants = guaranteed_scheduler(bearers, heap, &resource_blocks, current_tti, &num_popped);
+    // Level 1 bearers go back into the heap after the loop so none is served twice in a TTI
+    for (int i = 0; i < num_popped; i++) {
+        update_deadline(heap, &bearers[popped_bearers[i]], current_tti);
+    }
+
+    proportional_fair_level(bearers, num_bearers, resource_blocks, scenario.users_per_tti - grants, current_tti);
+
+    // Level 2 service and new packets move deadlines too
+    for (int i = 0; i < num_bearers; i++) {
+        Bearer *bearer = &bearers[i];
+        if (served_this_tti[i]) {
+            served_this_tti[i] = 0;
+            update_deadline(heap, bearer, current_tti);
+        } else if (bearer->qos_class == QOS_DELAY && bearer->queue_length > 0 &&
+                   !indexed_heap_contains(heap, i)) {
+            update_deadline(heap, bearer, current_tti);
+        }
+    }
+}
+
+void generate_TBSArray(int TBSArray[MAX_MCS_INDEX + 1][MAX_RB + 1]) {
+    int base_tbs = 100;
+    int increment_mcs = 50;
+    int increment_rb = 10;
+
+    for (int mcs = 0; mcs <= MAX_MCS_INDEX; mcs++) {
+        for (int rb = 0; rb <= MAX_RB; rb++) {
+            TBSArray[mcs][rb] = base_tbs + mcs * increment_mcs + rb * increment_rb;
+        }
+    }
+}
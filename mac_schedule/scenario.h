@@ -0,0 +1,276 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Scenario files replace the interactive prompt and the compile-time sizes.
+// One "key = value" per line, '#' starts a comment. Missing keys keep the defaults below.
+//
+//   cells = 1                  independent cells, run one after another with seed + cell (dynamic_users);
+//                              7, 19 or 37 hexagonal sites, or 3 sectors each (21, 57, 111) (multi_cell)
+//   users = 12                 UE population (sessions present at TTI 0 for dynamic_users)
+//   users_per_tti = 4          UEs selected per TTI
+//   resource_blocks = 100      RBs per TTI
+//   ttis = 10000               TTIs per run
+//   warmup_ttis = 0            TTIs run before the counters start, e.g. to settle PF averages and queues (hol_delay)
+//   scheduling_interval = 40   TTIs without service before a UE counts as delayed
+//   policy = pf                rr | maxci | pf, for binaries that offer more than one
+//   seed = 0                   0 seeds from the clock
+//   arrival_rate = 0           new sessions per TTI (dynamic_users)
+//   mean_session_ttis = 0      mean session length, 0 = sessions never end (dynamic_users)
+//   mcs_file = mcs_indices.dat fixed MCS table for the *1 simulators
+//   channel_trace =            MCS trace from channel_trace to replay instead of running the channel model (*2 simulators)
+//   tti_log =                  per-TTI decision log file, empty = off (dynamic_users)
+//   stats_file =               fairness statistics of the run for fairness_merge, empty = off (dynamic_users)
+//   antennas = 64              base station array size (mu_mimo)
+//   layers = 4                 most UEs co-scheduled on one RBG (mu_mimo)
+//   max_correlation = 0.3      largest precoder correlation allowed between paired UEs (mu_mimo)
+//   gbr_bearers = 0            bearers with a guaranteed bit rate, out of users (qos_scheduler)
+//   gbr_kbps = 256             guaranteed bit rate per GBR bearer (qos_scheduler)
+//   delay_bearers = 0          delay-critical bearers, out of users; the rest are best effort (qos_scheduler)
+//   delay_kbps = 64            offered load per delay-critical bearer (qos_scheduler)
+//   delay_budget_ttis = 20     packet delay budget of delay-critical bearers (qos_scheduler)
+//   workers = 1                threads ranking candidates within a TTI (dynamic_users) or running cells (multi_cell)
+//   parallel_threshold = 0     active UEs from which ranking is split, 0 = measure the crossover (dynamic_users)
+//   dl_kbps = 0                downlink offered load per UE, 0 = full buffer (multi_cell)
+//   ul_kbps = 64               uplink offered load per UE (duplex_cell)
+//   bsr_period_ttis = 5        TTIs between buffer status reports (duplex_cell)
+//   phr_period_ttis = 20       TTIs between power headroom reports (duplex_cell)
+//   carriers =                 RBs of each component carrier, comma separated; empty = one of resource_blocks (carrier_aggregation)
+
+#define SCENARIO_MAX_LINE 256
+#define SCENARIO_MAX_RB 273
+#define SCENARIO_MAX_LAYERS 16
+#define SCENARIO_MAX_CARRIERS 16
+
+typedef struct {
+    int cells;
+    int users;
+    int users_per_tti;
+    int resource_blocks;
+    int ttis;
+    int warmup_ttis;
+    int scheduling_interval;
+    char policy[16];
+    unsigned int seed;
+    double arrival_rate;
+    double mean_session_ttis;
+    char mcs_file[SCENARIO_MAX_LINE];
+    char channel_trace[SCENARIO_MAX_LINE];
+    char tti_log[SCENARIO_MAX_LINE];
+    char stats_file[SCENARIO_MAX_LINE];
+    int antennas;
+    int layers;
+    double max_correlation;
+    int gbr_bearers;
+    double gbr_kbps;
+    int delay_bearers;
+    double delay_kbps;
+    int delay_budget_ttis;
+    int workers;
+    int parallel_threshold;
+    double dl_kbps;
+    double ul_kbps;
+    int bsr_period_ttis;
+    int phr_period_ttis;
+    int num_carriers;
+    int carrier_rbs[SCENARIO_MAX_CARRIERS];
+} Scenario;
+
+static inline void scenario_defaults(Scenario *scenario) {
+    scenario->cells = 1;
+    scenario->users = 12;
+    scenario->users_per_tti = 4;
+    scenario->resource_blocks = 100;
+    scenario->ttis = 10000;
+    scenario->warmup_ttis = 0;
+    scenario->scheduling_interval = 40;
+    strcpy(scenario->policy, "pf");
+    scenario->seed = 0;
+    scenario->arrival_rate = 0.0;
+    scenario->mean_session_ttis = 0.0;
+    strcpy(scenario->mcs_file, "mcs_indices.dat");
+    scenario->channel_trace[0] = '\0';
+    scenario->tti_log[0] = '\0';
+    scenario->stats_file[0] = '\0';
+    scenario->antennas = 64;
+    scenario->layers = 4;
+    scenario->max_correlation = 0.3;
+    scenario->gbr_bearers = 0;
+    scenario->gbr_kbps = 256;
+    scenario->delay_bearers = 0;
+    scenario->delay_kbps = 64;
+    scenario->delay_budget_ttis = 20;
+    scenario->workers = 1;
+    scenario->parallel_threshold = 0;
+    scenario->dl_kbps = 0;
+    scenario->ul_kbps = 64;
+    scenario->bsr_period_ttis = 5;
+    scenario->phr_period_ttis = 20;
+    scenario->num_carriers = 0;
+}
+
+static inline char *scenario_trim(char *text) {
+    while (*text == ' ' || *text == '\t') {
+        text++;
+    }
+    char *end = text + strlen(text);
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) {
+        *--end = '\0';
+    }
+    return text;
+}
+
+static inline void scenario_fail(const char *path, int line, const char *message, const char *detail) {
+    fprintf(stderr, "%s:%d: %s '%s'\n", path, line, message, detail);
+    exit(EXIT_FAILURE);
+}
+
+static inline void scenario_parse_carriers(Scenario *scenario, const char *value, const char *path, int line) {
+    scenario->num_carriers = 0;
+    const char *cursor = value;
+    while (*cursor != '\0') {
+        char *end;
+        long blocks = strtol(cursor, &end, 10);
+        if (end == cursor || scenario->num_carriers == SCENARIO_MAX_CARRIERS || blocks < 1 || blocks > SCENARIO_MAX_RB) {
+            scenario_fail(path, line, "bad carrier list", value);
+        }
+        scenario->carrier_rbs[scenario->num_carriers++] = (int)blocks;
+        while (*end == ' ' || *end == '\t' || *end == ',') {
+            end++;
+        }
+        cursor = end;
+    }
+}
+
+static inline void scenario_set(Scenario *scenario, const char *key, const char *value, const char *path, int line) {
+    if (strcmp(key, "cells") == 0) {
+        scenario->cells = atoi(value);
+    } else if (strcmp(key, "users") == 0) {
+        scenario->users = atoi(value);
+    } else if (strcmp(key, "users_per_tti") == 0) {
+        scenario->users_per_tti = atoi(value);
+    } else if (strcmp(key, "resource_blocks") == 0) {
+        scenario->resource_blocks = atoi(value);
+    } else if (strcmp(key, "ttis") == 0) {
+        scenario->ttis = atoi(value);
+    } else if (strcmp(key, "warmup_ttis") == 0) {
+        scenario->warmup_ttis = atoi(value);
+    } else if (strcmp(key, "scheduling_interval") == 0) {
+        scenario->scheduling_interval = atoi(value);
+    } else if (strcmp(key, "policy") == 0) {
+        snprintf(scenario->policy, sizeof(scenario->policy), "%s", value);
+    } else if (strcmp(key, "seed") == 0) {
+        scenario->seed = (unsigned int)strtoul(value, NULL, 10);
+    } else if (strcmp(key, "arrival_rate") == 0) {
+        scenario->arrival_rate = atof(value);
+    } else if (strcmp(key, "mean_session_ttis") == 0) {
+        scenario->mean_session_ttis = atof(value);
+    } else if (strcmp(key, "mcs_file") == 0) {
+        snprintf(scenario->mcs_file, sizeof(scenario->mcs_file), "%s", value);
+    } else if (strcmp(key, "channel_trace") == 0) {
+        snprintf(scenario->channel_trace, sizeof(scenario->channel_trace), "%s", value);
+    } else if (strcmp(key, "tti_log") == 0) {
+        snprintf(scenario->tti_log, sizeof(scenario->tti_log), "%s", value);
+    } else if (strcmp(key, "stats_file") == 0) {
+        snprintf(scenario->stats_file, sizeof(scenario->stats_file), "%s", value);
+    } else if (strcmp(key, "antennas") == 0) {
+        scenario->antennas = atoi(value);
+    } else if (strcmp(key, "layers") == 0) {
+        scenario->layers = atoi(value);
+    } else if (strcmp(key, "max_correlation") == 0) {
+        scenario->max_correlation = atof(value);
+    } else if (strcmp(key, "gbr_bearers") == 0) {
+        scenario->gbr_bearers = atoi(value);
+    } else if (strcmp(key, "gbr_kbps") == 0) {
+        scenario->gbr_kbps = atof(value);
+    } else if (strcmp(key, "delay_bearers") == 0) {
+        scenario->delay_bearers = atoi(value);
+    } else if (strcmp(key, "delay_kbps") == 0) {
+        scenario->delay_kbps = atof(value);
+    } else if (strcmp(key, "delay_budget_ttis") == 0) {
+        scenario->delay_budget_ttis = atoi(value);
+    } else if (strcmp(key, "workers") == 0) {
+        scenario->workers = atoi(value);
+    } else if (strcmp(key, "parallel_threshold") == 0) {
+        scenario->parallel_threshold = atoi(value);
+    } else if (strcmp(key, "dl_kbps") == 0) {
+        scenario->dl_kbps = atof(value);
+    } else if (strcmp(key, "ul_kbps") == 0) {
+        scenario->ul_kbps = atof(value);
+    } else if (strcmp(key, "bsr_period_ttis") == 0) {
+        scenario->bsr_period_ttis = atoi(value);
+    } else if (strcmp(key, "phr_period_ttis") == 0) {
+        scenario->phr_period_ttis = atoi(value);
+    } else if (strcmp(key, "carriers") == 0) {
+        scenario_parse_carriers(scenario, value, path, line);
+    } else {
+        scenario_fail(path, line, "unknown key", key);
+    }
+}
+
+// Applies the keys in path over the current values
+static inline void scenario_read(const char *path, Scenario *scenario) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror("Failed to open scenario file");
+        exit(EXIT_FAILURE);
+    }
+
+    char buffer[SCENARIO_MAX_LINE];
+    int line = 0;
+    while (fgets(buffer, sizeof(buffer), file) != NULL) {
+        line++;
+        char *comment = strchr(buffer, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+        char *text = scenario_trim(buffer);
+        if (*text == '\0') {
+            continue;
+        }
+        char *equals = strchr(text, '=');
+        if (equals == NULL) {
+            scenario_fail(path, line, "expected key = value, got", text);
+        }
+        *equals = '\0';
+        scenario_set(scenario, scenario_trim(text), scenario_trim(equals + 1), path, line);
+    }
+    fclose(file);
+}
+
+static inline void scenario_validate(const char *path, const Scenario *scenario) {
+    if (scenario->cells < 1 || scenario->users < 1 || scenario->users_per_tti < 1 ||
+        scenario->resource_blocks < 1 || scenario->resource_blocks > SCENARIO_MAX_RB ||
+        scenario->users_per_tti > scenario->users || scenario->ttis < 1 || scenario->warmup_ttis < 0 ||
+        scenario->scheduling_interval < 1 ||
+        scenario->arrival_rate < 0 || scenario->mean_session_ttis < 0 ||
+        scenario->antennas < 1 || scenario->layers < 1 || scenario->layers > SCENARIO_MAX_LAYERS ||
+        scenario->max_correlation < 0 || scenario->max_correlation > 1 ||
+        scenario->gbr_bearers < 0 || scenario->delay_bearers < 0 ||
+        scenario->gbr_bearers + scenario->delay_bearers > scenario->users ||
+        scenario->gbr_kbps <= 0 || scenario->delay_kbps <= 0 || scenario->delay_budget_ttis < 1 ||
+        scenario->workers < 1 || scenario->parallel_threshold < 0 ||
+        scenario->dl_kbps < 0 || scenario->ul_kbps < 0 || scenario->bsr_period_ttis < 1 || scenario->phr_period_ttis < 1) {
+        fprintf(stderr, "%s: scenario values out of range\n", path ? path : "defaults");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Loads path over the defaults; a NULL path keeps the defaults
+static inline void load_scenario(const char *path, Scenario *scenario) {
+    scenario_defaults(scenario);
+    if (path != NULL) {
+        scenario_read(path, scenario);
+    }
+    scenario_validate(path, scenario);
+}
+
+static inline unsigned int scenario_seed(const Scenario *scenario) {
+    return scenario->seed != 0 ? scenario->seed : (unsigned int)time(NULL);
+}
+
+#endif
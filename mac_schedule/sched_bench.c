@@ -0,0 +1,352 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "perf_counters.h"
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+// Scheduler micro-benchmark. Each build pulls in one simulator source and times its
+// scheduler function per TTI over a grid of user and RB counts; sched_bench.sh builds
+// and runs all of them. Output is CSV on stdout:
+//   scheduler,users,rbs,ttis_per_trial,trials,ns_per_tti_median,ns_per_tti_min,tsc_cycles_per_ue,allocs_per_tti
+//
+// Each TTI also runs the simulator's own per-TTI MCS update before the scheduler, so the
+// ranking sees inputs that move the way they do in a real run: the *1 variants and round
+// robin run link_adaptation (OLLA over a CQI report with a fixed error), the *2 variants
+// copy in the next row of channel model MCS. The channel rows are generated before timing
+// (BENCH_CHANNEL_TTIS of them, replayed in a loop), since stepping the model itself costs
+// about as much per UE as ranking. The update runs outside the timed region: only the
+// scheduler call is timed, less the cost of an empty timing bracket measured at startup.
+//
+// With BENCH_PERF set, every point also gets an untimed pass with hardware counters around
+// each scheduler call (perf_counters.h), reported per scheduler and user-count bucket on stderr.
+//
+// Build one variant by hand with e.g.
+//   gcc -O2 -DBENCH_RR sched_bench.c -o sched_bench_rr -lm -lpthread
+
+#if defined(BENCH_RR)
+#define BENCH_SOURCE "round_robin.c"
+#define BENCH_NAME "round_robin_scheduler"
+#elif defined(BENCH_MAXCI1)
+#define BENCH_SOURCE "maximum_ci1.c"
+#define BENCH_NAME "maximum_ci_scheduler(ci1)"
+#elif defined(BENCH_MAXCI2)
+#define BENCH_SOURCE "maximum_ci2.c"
+#define BENCH_NAME "maximum_ci_scheduler(ci2)"
+#elif defined(BENCH_PF1)
+#define BENCH_SOURCE "proportional_fair1.c"
+#define BENCH_NAME "proportional_fair_scheduler"
+#elif defined(BENCH_PF2)
+#define BENCH_SOURCE "proportional_fair2.c"
+#define BENCH_NAME "proportional_scheduler"
+#elif defined(BENCH_DYNAMIC)
+#define BENCH_SOURCE "dynamic_users.c"
+#define BENCH_NAME "dynamic_scheduler"
+#else
+#error "Define one of BENCH_RR, BENCH_MAXCI1, BENCH_MAXCI2, BENCH_PF1, BENCH_PF2, BENCH_DYNAMIC"
+#endif
+
+#define main simulator_main
+#include BENCH_SOURCE
+#undef main
+
+#define BENCH_TRIALS 7
+#define BENCH_TTI_BUDGET 2000000   // users * TTIs per trial
+#define BENCH_MIN_TTIS 20
+#define BENCH_MAX_TTIS 20000
+#define BENCH_SEED 12345
+#define BENCH_CHANNEL_TTIS 64
+#define BENCH_OVERHEAD_SAMPLES 10001
+
+static const int bench_users[] = {12, 100, 1000, 10000, 100000};
+static const int bench_rbs[] = {6, 25, 50, 100, 273};
+
+// Counting wrappers around the glibc allocator, so allocations per TTI can be reported
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+long long allocation_count = 0;
+PerfCounters perf;
+double timer_overhead_ns = 0;     // median cost of an empty timing bracket
+double timer_overhead_cycles = 0;
+
+void *malloc(size_t size) {
+    allocation_count++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    allocation_count++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    allocation_count++;
+    return __libc_realloc(ptr, size);
+}
+
+static inline unsigned long long bench_cycles() {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static inline double bench_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+#if defined(BENCH_DYNAMIC)
+UEPool bench_pool;
+const SchedulerPolicy *bench_policy;
+
+void bench_setup(int num_users) {
+    ue_pool_init(&bench_pool, num_users);
+    selected_slots = malloc(scenario.users_per_tti * sizeof(int));
+    selected_keys = malloc(scenario.users_per_tti * sizeof(long long));
+    rr_cursor = 0;
+    for (int i = 0; i < num_users; i++) {
+        int slot = ue_pool_alloc(&bench_pool);
+        bench_pool.user_id[slot] = i;
+        bench_pool.mcs_index[slot] = rand() % (MAX_MCS_INDEX + 1);
+    }
+}
+
+// dynamic_users keeps the MCS fixed per session
+void bench_update_mcs(int num_users, int tti) {
+}
+
+void bench_schedule(int num_users, int tti) {
+    dynamic_scheduler(&bench_pool, bench_policy, scenario.resource_blocks, tti);
+}
+
+void bench_teardown() {
+    ue_pool_free(&bench_pool);
+    free(selected_slots);
+    free(selected_keys);
+}
+#else
+User *bench_users_array;
+#if defined(BENCH_MAXCI2) || defined(BENCH_PF2)
+ChannelModel bench_channel;
+uint8_t *bench_channel_mcs;     // BENCH_CHANNEL_TTIS rows of num_users
+#endif
+
+void bench_setup(int num_users) {
+    bench_users_array = calloc(num_users, sizeof(User));
+    for (int i = 0; i < num_users; i++) {
+        User *user = &bench_users_array[i];
+        user->user_id = i;
+        user->mcs_index = rand() % (MAX_MCS_INDEX + 1);
+#if defined(BENCH_PF2)
+        user->last_scheduled_tti = -1;
+#endif
+#if defined(BENCH_RR) || defined(BENCH_MAXCI1) || defined(BENCH_PF1)
+        // As load_mcs_indices: the MCS is the CQI report, the real channel is off by up to the report error
+        user->reported_sinr_db = olla_mcs_sinr_db(user->mcs_index);
+        user->channel_sinr_db = user->reported_sinr_db + ((double)rand() / RAND_MAX * 2.0 - 1.0) * CQI_REPORT_ERROR_DB;
+        user->olla_offset_db = 0.0;
+#endif
+    }
+#if defined(BENCH_PF2)
+    delay_users = malloc(num_users * sizeof(User));
+    non_delay_users = malloc(num_users * sizeof(User));
+#endif
+#if defined(BENCH_MAXCI2) || defined(BENCH_PF2)
+    channel_model_init(&bench_channel, num_users, BENCH_SEED);
+    bench_channel_mcs = malloc((size_t)BENCH_CHANNEL_TTIS * num_users);
+    if (bench_channel_mcs == NULL) {
+        perror("Failed to allocate channel rows");
+        exit(EXIT_FAILURE);
+    }
+    channel_model_generate(&bench_channel, BENCH_CHANNEL_TTIS, bench_channel_mcs);
+#endif
+}
+
+void bench_update_mcs(int num_users, int tti) {
+    User *users = bench_users_array;
+#if defined(BENCH_MAXCI2) || defined(BENCH_PF2)
+    memcpy(bench_channel.mcs, bench_channel_mcs + (size_t)(tti % BENCH_CHANNEL_TTIS) * num_users, num_users);
+    update_channel_mcs(users, num_users, &bench_channel);
+#else
+    link_adaptation(users, num_users);
+#endif
+}
+
+void bench_schedule(int num_users, int tti) {
+    User *users = bench_users_array;
+    int rbs = scenario.resource_blocks;
+#if defined(BENCH_RR)
+    round_robin_scheduler(users, num_users, rbs, (tti * scenario.users_per_tti) % num_users);
+#elif defined(BENCH_MAXCI1) || defined(BENCH_MAXCI2)
+    maximum_ci_scheduler(users, num_users, rbs);
+#elif defined(BENCH_PF1)
+    proportional_fair_scheduler(users, num_users, rbs, tti);
+#elif defined(BENCH_PF2)
+    proportional_scheduler(users, num_users, rbs, tti);
+#endif
+}
+
+void bench_teardown() {
+    free(bench_users_array);
+#if defined(BENCH_PF2)
+    free(delay_users);
+    free(non_delay_users);
+#endif
+#if defined(BENCH_MAXCI2) || defined(BENCH_PF2)
+    channel_model_free(&bench_channel);
+    free(bench_channel_mcs);
+#endif
+}
+#endif
+
+void pin_cpu() {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        perror("sched_getaffinity");
+        return;
+    }
+    int cpu = -1;
+    const char *requested = getenv("BENCH_CPU");
+    if (requested != NULL) {
+        cpu = atoi(requested);
+    } else {
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+            if (CPU_ISSET(i, &allowed)) {
+                cpu = i;    // last allowed CPU, away from where interrupts usually land
+            }
+        }
+    }
+
+    cpu_set_t pinned;
+    CPU_ZERO(&pinned);
+    CPU_SET(cpu, &pinned);
+    if (sched_setaffinity(0, sizeof(pinned), &pinned) != 0) {
+        perror("sched_setaffinity");
+        return;
+    }
+    fprintf(stderr, "# %s pinned to CPU %d\n", BENCH_NAME, cpu);
+}
+
+void measure_timer_overhead() {
+    static double samples[BENCH_OVERHEAD_SAMPLES];
+    static double cycle_samples[BENCH_OVERHEAD_SAMPLES];
+    for (int i = 0; i < BENCH_OVERHEAD_SAMPLES; i++) {
+        unsigned long long cycles_before = bench_cycles();
+        double start = bench_now_ns();
+        samples[i] = bench_now_ns() - start;
+        cycle_samples[i] = bench_cycles() - cycles_before;
+    }
+    qsort(samples, BENCH_OVERHEAD_SAMPLES, sizeof(double), compare_doubles);
+    qsort(cycle_samples, BENCH_OVERHEAD_SAMPLES, sizeof(double), compare_doubles);
+    timer_overhead_ns = samples[BENCH_OVERHEAD_SAMPLES / 2];
+    timer_overhead_cycles = cycle_samples[BENCH_OVERHEAD_SAMPLES / 2];
+    fprintf(stderr, "# timing bracket costs %.1f ns, subtracted per TTI\n", timer_overhead_ns);
+}
+
+void run_point(const char *name, int num_users, int rbs) {
+    double trial_ns[BENCH_TRIALS];
+    unsigned long long cycles = 0;
+    long long allocations = 0;
+    int ttis = BENCH_TTI_BUDGET / num_users;
+    if (ttis < BENCH_MIN_TTIS) {
+        ttis = BENCH_MIN_TTIS;
+    }
+    if (ttis > BENCH_MAX_TTIS) {
+        ttis = BENCH_MAX_TTIS;
+    }
+
+    scenario.resource_blocks = rbs;
+    srand(BENCH_SEED);
+    bench_setup(num_users);
+
+    // Warm-up pass so the user array, TBSArray and code are hot before timing
+    int tti = 0;
+    for (int i = 0; i < ttis; i++, tti++) {
+        bench_update_mcs(num_users, tti);
+        bench_schedule(num_users, tti);
+    }
+
+    // Only the scheduler call is inside the brackets
+    for (int trial = 0; trial < BENCH_TRIALS; trial++) {
+        double elapsed = 0;
+        for (int i = 0; i < ttis; i++, tti++) {
+            bench_update_mcs(num_users, tti);
+            long long allocations_before = allocation_count;
+            unsigned long long cycles_before = bench_cycles();
+            double start = bench_now_ns();
+            bench_schedule(num_users, tti);
+            elapsed += bench_now_ns() - start;
+            cycles += bench_cycles() - cycles_before;
+            allocations += allocation_count - allocations_before;
+        }
+        trial_ns[trial] = elapsed / ttis - timer_overhead_ns;
+    }
+
+    for (int i = 0; perf.enabled && i < ttis; i++, tti++) {
+        bench_update_mcs(num_users, tti);
+        perf_begin(&perf);
+        bench_schedule(num_users, tti);
+        perf_end(&perf, name, num_users);
+    }
+
+    bench_teardown();
+
+    qsort(trial_ns, BENCH_TRIALS, sizeof(double), compare_doubles);
+    double total_ttis = (double)ttis * BENCH_TRIALS;
+    printf("%s,%d,%d,%d,%d,%.1f,%.1f,%.2f,%.3f\n", name, num_users, rbs, ttis, BENCH_TRIALS,
+           trial_ns[BENCH_TRIALS / 2], trial_ns[0], (cycles / total_ttis - timer_overhead_cycles) / num_users,
+           allocations / total_ttis);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s", BENCH_NAME);
+
+    scenario_defaults(&scenario);
+    generate_TBSArray(TBSArray);
+#ifdef OLLA_H
+    olla_init_tables();
+#endif
+#if defined(BENCH_DYNAMIC)
+    const char *policy = argc > 1 ? argv[1] : "pf";
+    bench_policy = find_scheduler_policy(policy);
+    if (bench_policy == NULL) {
+        fprintf(stderr, "Unknown policy '%s'\n", policy);
+        return 1;
+    }
+    snprintf(name, sizeof(name), "%s(%s)", BENCH_NAME, policy);
+#endif
+
+    pin_cpu();
+    measure_timer_overhead();
+    if (getenv("BENCH_PERF") != NULL && !perf_counters_open(&perf)) {
+        fprintf(stderr, "# no hardware counters available\n");
+    }
+    if (getenv("BENCH_NO_HEADER") == NULL) {
+        printf("scheduler,users,rbs,ttis_per_trial,trials,ns_per_tti_median,ns_per_tti_min,tsc_cycles_per_ue,allocs_per_tti\n");
+    }
+
+    for (size_t u = 0; u < sizeof(bench_users) / sizeof(bench_users[0]); u++) {
+        for (size_t r = 0; r < sizeof(bench_rbs) / sizeof(bench_rbs[0]); r++) {
+            run_point(name, bench_users[u], bench_rbs[r]);
+        }
+    }
+    perf_report(&perf, stderr);
+    perf_counters_close(&perf);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Builds sched_bench for every scheduler and prints one CSV with all results.
+# Usage: ./sched_bench.sh [output.csv]     (BENCH_CPU=<n> picks the pinned CPU,
+#                                          BENCH_PERF=1 adds hardware counters on stderr)
+set -e
+
+cd "$(dirname "$0")"
+build_dir=$(mktemp -d)
+trap 'rm -rf "$build_dir"' EXIT
+
+for variant in RR MAXCI1 MAXCI2 PF1 PF2 DYNAMIC; do
+    gcc -O2 -D"BENCH_$variant" sched_bench.c -o "$build_dir/sched_bench_$variant" -lm -lpthread
+done
+
+run() {
+    "$build_dir/sched_bench_RR"
+    for variant in MAXCI1 MAXCI2 PF1 PF2; do
+        BENCH_NO_HEADER=1 "$build_dir/sched_bench_$variant"
+    done
+    for policy in rr maxci pf; do
+        BENCH_NO_HEADER=1 "$build_dir/sched_bench_DYNAMIC" "$policy"
+    done
+}
+
+if [ -n "$1" ]; then
+    run > "$1"
+else
+    run
+fi
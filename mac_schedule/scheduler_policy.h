@@ -0,0 +1,135 @@
+#ifndef SCHEDULER_POLICY_H
+#define SCHEDULER_POLICY_H
+
+#include <string.h>
+
+// Specialized per-TTI selection for the ranking policies.
+// SCHEDULER_POLICY(name, METRIC, TIE_BREAK) stamps out select_<name>() with the metric and
+// tie-break expanded inline, the way a template parameter would be: each policy gets its
+// own key loop (one 64-bit key per UE, metric in the high half, tie-break in the low half,
+// computed with no calls or branches so it vectorizes) followed by a top-K pass that
+// compares plain integers. No qsort, no comparison callback.
+//
+// scheduler_policies[] maps the scenario's policy name to the generated functions, so one
+// binary still picks its policy at run time with one indirect call per TTI.
+//
+// Inside METRIC and TIE_BREAK: `slot` is the UE, `position` its place in the candidate list
+// and `in` the SchedulerInput. A worker ranking one chunk of a larger list sets
+// candidate_base to the chunk's start, so positions and tie-breaks stay global.
+
+typedef struct {
+    int num_candidates;
+    int candidate_base;             // position of candidates[0] in the full list
+    const int *candidates;          // UE slots to rank
+    const int *mcs_index;           // indexed by slot
+    const int *last_scheduled_tti;  // indexed by slot
+    int current_tti;
+    int scheduling_interval;
+    int *rr_cursor;
+    long long *keys;                // scratch, at least num_candidates
+    long long *best;                // scratch, at least the selection count; holds the selected keys on return
+} SchedulerInput;
+
+typedef int (*SchedulerSelectFn)(const SchedulerInput *in, int count, int *selected);
+
+typedef struct {
+    const char *name;
+    SchedulerSelectFn select;
+    int ranks;                      // 1 if the selection is a top-K over keys and can be split into chunks
+} SchedulerPolicy;
+
+// Keeps the count largest keys in descending order; selected[] receives their slots
+static inline int scheduler_top_k(const SchedulerInput *in, int count, int *selected, long long *best) {
+    int n = in->num_candidates;
+    int found = 0;
+    for (int i = 0; i < n; i++) {
+        long long key = in->keys[i];
+        if (found == count && key <= best[count - 1]) {
+            continue;
+        }
+        int pos = found < count ? found++ : count - 1;
+        while (pos > 0 && best[pos - 1] < key) {
+            best[pos] = best[pos - 1];
+            selected[pos] = selected[pos - 1];
+            pos--;
+        }
+        best[pos] = key;
+        selected[pos] = in->candidates[i];
+    }
+    return found;
+}
+
+// The same top-K for callers that compute a float or double key per candidate in their own
+// loop (with their own filters): offers one candidate, keeping the count largest keys seen so
+// far in descending order in keys[] and their items in selected[]. *found starts at 0.
+// Earlier candidates win ties.
+#define SCHEDULER_TOP_K_KEY(suffix, type)                                                           \
+    static inline void scheduler_top_k_##suffix(type key, int item, int count, int *found, type *keys, \
+                                                int *selected) {                                    \
+        if (*found == count && key <= keys[count - 1]) {                                            \
+            return;                                                                                 \
+        }                                                                                           \
+        int pos = *found < count ? (*found)++ : count - 1;                                          \
+        while (pos > 0 && keys[pos - 1] < key) {                                                    \
+            keys[pos] = keys[pos - 1];                                                              \
+            selected[pos] = selected[pos - 1];                                                      \
+            pos--;                                                                                  \
+        }                                                                                           \
+        keys[pos] = key;                                                                            \
+        selected[pos] = item;                                                                       \
+    }
+
+SCHEDULER_TOP_K_KEY(float, float)
+SCHEDULER_TOP_K_KEY(double, double)
+
+#define SCHEDULER_POLICY(name, METRIC, TIE_BREAK)                                              \
+    static int select_##name(const SchedulerInput *in, int count, int *selected) {             \
+        const int *restrict candidates = in->candidates;                                       \
+        long long *restrict keys = in->keys;                                                   \
+        for (int i = 0; i < in->num_candidates; i++) {                                         \
+            int slot = candidates[i];                                                          \
+            int position = in->candidate_base + i;                                             \
+            keys[i] = ((long long)(METRIC) << 32) | (unsigned int)(TIE_BREAK);                 \
+        }                                                                                      \
+        return scheduler_top_k(in, count, selected, in->best);                                 \
+    }
+
+// Earlier candidates win ties, as with the insertion selection they replace
+#define TIE_FIRST_CANDIDATE (0x7fffffff - position)
+
+SCHEDULER_POLICY(maxci, in->mcs_index[slot], TIE_FIRST_CANDIDATE)
+SCHEDULER_POLICY(pf,
+                 in->mcs_index[slot] |
+                     ((in->current_tti - in->last_scheduled_tti[slot] >= in->scheduling_interval) << 8),
+                 TIE_FIRST_CANDIDATE)
+
+// Round robin does not rank: it takes the next count candidates after the cursor
+static int select_rr(const SchedulerInput *in, int count, int *selected) {
+    int n = in->num_candidates;
+    if (count > n) {
+        count = n;
+    }
+    int cursor = n > 0 ? *in->rr_cursor % n : 0;
+    for (int i = 0; i < count; i++) {
+        selected[i] = in->candidates[(cursor + i) % n];
+    }
+    *in->rr_cursor = cursor + count;
+    return count;
+}
+
+static const SchedulerPolicy scheduler_policies[] = {
+    {"rr", select_rr, 0},
+    {"maxci", select_maxci, 1},
+    {"pf", select_pf, 1},
+};
+
+static inline const SchedulerPolicy *find_scheduler_policy(const char *name) {
+    for (size_t i = 0; i < sizeof(scheduler_policies) / sizeof(scheduler_policies[0]); i++) {
+        if (strcmp(scheduler_policies[i].name, name) == 0) {
+            return &scheduler_policies[i];
+        }
+    }
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,272 @@
+#ifndef SCORE_POOL_H
+#define SCORE_POOL_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "scheduler_policy.h"
+
+// Persistent worker pool for ranking very large candidate lists within one TTI.
+// The candidate list is cut into one chunk per thread (the calling thread takes chunk 0);
+// each computes keys and a partial top-K for its chunk with the policy's own select
+// function, and the caller merges the sorted partial lists. Chunks carry their global
+// start as candidate_base, so the result is identical to the serial selection.
+//
+// Per TTI the only synchronization is one generation bump with a broadcast to start and a
+// countdown to finish. Both sides spin for SCORE_POOL_SPINS polls before sleeping on the
+// condition variable, so back-to-back TTIs usually avoid the futex round trip.
+//
+// Splitting only pays off above some list size; score_pool_crossover() measures where.
+
+#define SCORE_POOL_MAX_WORKERS 64
+#define SCORE_POOL_SPINS 4000
+#define SCORE_POOL_CALIBRATION_REPEATS 20
+
+typedef struct ScorePool ScorePool;
+
+typedef struct {
+    ScorePool *pool;
+    int index;
+    pthread_t thread;
+    int found;
+    int *selected;
+    long long *keys;
+} ScoreWorker;
+
+struct ScorePool {
+    int num_threads;                // workers plus the calling thread
+    ScoreWorker workers[SCORE_POOL_MAX_WORKERS];
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    atomic_int generation;
+    atomic_int pending;
+    int stopping;
+    const SchedulerPolicy *policy;  // current job
+    const SchedulerInput *input;
+    int count;
+};
+
+static inline void score_pool_run_chunk(ScorePool *pool, ScoreWorker *worker) {
+    const SchedulerInput *in = pool->input;
+    int n = in->num_candidates;
+    int start = (int)((long long)n * worker->index / pool->num_threads);
+    int end = (int)((long long)n * (worker->index + 1) / pool->num_threads);
+
+    SchedulerInput chunk = *in;
+    chunk.num_candidates = end - start;
+    chunk.candidate_base = in->candidate_base + start;
+    chunk.candidates = in->candidates + start;
+    chunk.keys = in->keys + start;
+    chunk.best = worker->keys;
+    worker->found = end > start ? pool->policy->select(&chunk, pool->count, worker->selected) : 0;
+}
+
+static void *score_pool_worker(void *arg) {
+    ScoreWorker *worker = (ScoreWorker *)arg;
+    ScorePool *pool = worker->pool;
+    int seen = 0;
+
+    while (1) {
+        int spins = 0;
+        while (atomic_load_explicit(&pool->generation, memory_order_acquire) == seen && spins < SCORE_POOL_SPINS) {
+            spins++;
+        }
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->generation) == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        seen = atomic_load(&pool->generation);
+        int stopping = pool->stopping;
+        pthread_mutex_unlock(&pool->lock);
+        if (stopping) {
+            break;
+        }
+
+        score_pool_run_chunk(pool, worker);
+        if (atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_acq_rel) == 1) {
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->done);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+    return NULL;
+}
+
+// max_count is the largest selection count score_pool_select() will be asked for
+static inline void score_pool_init(ScorePool *pool, int num_threads, int max_count) {
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (num_threads > SCORE_POOL_MAX_WORKERS) {
+        num_threads = SCORE_POOL_MAX_WORKERS;
+    }
+    pool->num_threads = num_threads;
+    pool->stopping = 0;
+    atomic_init(&pool->generation, 0);
+    atomic_init(&pool->pending, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for (int w = 0; w < num_threads; w++) {
+        ScoreWorker *worker = &pool->workers[w];
+        worker->pool = pool;
+        worker->index = w;
+        worker->selected = malloc(max_count * sizeof(int));
+        worker->keys = malloc(max_count * sizeof(long long));
+        if (w > 0 && pthread_create(&worker->thread, NULL, score_pool_worker, worker) != 0) {
+            perror("Failed to start scoring worker");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static inline void score_pool_free(ScorePool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    atomic_fetch_add(&pool->generation, 1);
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int w = 0; w < pool->num_threads; w++) {
+        if (w > 0) {
+            pthread_join(pool->workers[w].thread, NULL);
+        }
+        free(pool->workers[w].selected);
+        free(pool->workers[w].keys);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+}
+
+// Same contract as policy->select(); the policy must rank (policy->ranks)
+static inline int score_pool_select(ScorePool *pool, const SchedulerPolicy *policy, const SchedulerInput *in,
+                                    int count, int *selected) {
+    pool->policy = policy;
+    pool->input = in;
+    pool->count = count;
+
+    atomic_store(&pool->pending, pool->num_threads - 1);
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add_explicit(&pool->generation, 1, memory_order_release);
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    score_pool_run_chunk(pool, &pool->workers[0]);
+
+    int spins = 0;
+    while (atomic_load_explicit(&pool->pending, memory_order_acquire) > 0 && spins < SCORE_POOL_SPINS) {
+        spins++;
+    }
+    if (atomic_load_explicit(&pool->pending, memory_order_acquire) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->pending) > 0) {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    // Merge the sorted partial lists: count rounds of picking the best head
+    int head[SCORE_POOL_MAX_WORKERS] = {0};
+    int found = 0;
+    while (found < count) {
+        int best = -1;
+        for (int w = 0; w < pool->num_threads; w++) {
+            ScoreWorker *worker = &pool->workers[w];
+            if (head[w] < worker->found &&
+                (best < 0 || worker->keys[head[w]] > pool->workers[best].keys[head[best]])) {
+                best = w;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        selected[found++] = pool->workers[best].selected[head[best]++];
+    }
+    return found;
+}
+
+static inline double score_pool_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Times serial and pooled selection on synthetic candidate lists of growing size and returns
+// the smallest size from which the pool is faster at every larger size measured, or -1 if it
+// never is. Prints the measurements to out when out is not NULL.
+static inline int score_pool_crossover(ScorePool *pool, const SchedulerPolicy *policy, int count, FILE *out) {
+    static const int sizes[] = {1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000};
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    int max_size = sizes[num_sizes - 1];
+    int *candidates = malloc(max_size * sizeof(int));
+    int *mcs_index = malloc(max_size * sizeof(int));
+    int *last_scheduled = malloc(max_size * sizeof(int));
+    long long *keys = malloc(max_size * sizeof(long long));
+    int *selected = malloc(count * sizeof(int));
+    long long *best = malloc(count * sizeof(long long));
+    int cursor = 0;
+    for (int i = 0; i < max_size; i++) {
+        candidates[i] = i;
+        mcs_index[i] = (int)((i * 2654435761u) >> 27) % 29;
+        last_scheduled[i] = -(int)((i * 40503u) % 64);
+    }
+
+    SchedulerInput in = {0};
+    in.candidates = candidates;
+    in.mcs_index = mcs_index;
+    in.last_scheduled_tti = last_scheduled;
+    in.current_tti = 0;
+    in.scheduling_interval = 40;
+    in.rr_cursor = &cursor;
+    in.keys = keys;
+    in.best = best;
+
+    int crossover = -1;
+    if (out != NULL) {
+        fprintf(out, "# %-10s %14s %14s\n", "candidates", "serial ns", "pooled ns");
+    }
+    for (int s = 0; s < num_sizes; s++) {
+        in.num_candidates = sizes[s];
+        policy->select(&in, count, selected);
+        double start = score_pool_now_ns();
+        for (int r = 0; r < SCORE_POOL_CALIBRATION_REPEATS; r++) {
+            policy->select(&in, count, selected);
+        }
+        double serial = (score_pool_now_ns() - start) / SCORE_POOL_CALIBRATION_REPEATS;
+
+        score_pool_select(pool, policy, &in, count, selected);
+        start = score_pool_now_ns();
+        for (int r = 0; r < SCORE_POOL_CALIBRATION_REPEATS; r++) {
+            score_pool_select(pool, policy, &in, count, selected);
+        }
+        double pooled = (score_pool_now_ns() - start) / SCORE_POOL_CALIBRATION_REPEATS;
+
+        if (out != NULL) {
+            fprintf(out, "# %-10d %14.0f %14.0f\n", sizes[s], serial, pooled);
+        }
+        if (pooled < serial) {
+            if (crossover < 0) {
+                crossover = sizes[s];
+            }
+        } else {
+            crossover = -1;
+        }
+    }
+
+    free(candidates);
+    free(mcs_index);
+    free(last_scheduled);
+    free(keys);
+    free(selected);
+    free(best);
+    return crossover;
+}
+
+#endif
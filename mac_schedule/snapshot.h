@@ -0,0 +1,249 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "channel_model.h"
+#include "indexed_heap.h"
+
+// Checkpoints of simulator state, and branching many runs off one warmed-up state.
+//
+// A snapshot is a header and a sequence of tagged sections. Simulator state is already kept
+// in flat arrays, so each section is one array or struct written as it sits in memory, and
+// saving or restoring is a handful of large fwrite/fread calls. The reader asks for the
+// sections in the order they were written and checks every tag and size, so a snapshot from
+// another scenario or build is rejected rather than misread. Snapshots are meant to be read
+// back by the same binary on the same machine.
+//
+// snapshot_branch() forks one child per variant after the warm-up. The children share the
+// warmed state copy-on-write, so each only pays for the pages it changes. They run at the
+// same time, and their reports come back through pipes and are printed in variant order.
+
+#define SNAPSHOT_MAGIC "MCSS"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_MAX_BRANCHES 64
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+} SnapshotHeader;
+
+typedef struct {
+    char tag[8];
+    uint64_t bytes;
+} SnapshotSection;
+
+static inline FILE *snapshot_create(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        perror("Failed to create snapshot");
+        exit(EXIT_FAILURE);
+    }
+    SnapshotHeader header = {{0}, SNAPSHOT_VERSION};
+    memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    if (fwrite(&header, sizeof(header), 1, file) != 1) {
+        perror("Failed to write snapshot");
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+static inline FILE *snapshot_open(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Failed to open snapshot");
+        exit(EXIT_FAILURE);
+    }
+    SnapshotHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, SNAPSHOT_MAGIC, 4) != 0 ||
+        header.version != SNAPSHOT_VERSION) {
+        fprintf(stderr, "%s is not a version %d snapshot\n", path, SNAPSHOT_VERSION);
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+static inline void snapshot_put(FILE *file, const char *tag, const void *data, size_t bytes) {
+    SnapshotSection section = {{0}, bytes};
+    size_t length = strlen(tag);
+    memcpy(section.tag, tag, length < sizeof(section.tag) ? length : sizeof(section.tag));
+    if (fwrite(&section, sizeof(section), 1, file) != 1 || (bytes > 0 && fwrite(data, bytes, 1, file) != 1)) {
+        perror("Failed to write snapshot");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static inline void snapshot_get(FILE *file, const char *tag, void *data, size_t bytes) {
+    SnapshotSection section;
+    if (fread(&section, sizeof(section), 1, file) != 1 || strncmp(section.tag, tag, sizeof(section.tag)) != 0 ||
+        section.bytes != bytes) {
+        fprintf(stderr, "Snapshot does not match: expected section '%s' of %zu bytes\n", tag, bytes);
+        exit(EXIT_FAILURE);
+    }
+    if (bytes > 0 && fread(data, bytes, 1, file) != 1) {
+        fprintf(stderr, "Snapshot is truncated in section '%s'\n", tag);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Every per-UE array, including the random streams, so a restored channel continues exactly
+static inline void snapshot_put_channel(FILE *file, const ChannelModel *channel) {
+    size_t n = channel->num_ues;
+    snapshot_put(file, "ch.ues", &channel->num_ues, sizeof(channel->num_ues));
+    snapshot_put(file, "ch.posx", channel->pos_x, n * sizeof(float));
+    snapshot_put(file, "ch.posy", channel->pos_y, n * sizeof(float));
+    snapshot_put(file, "ch.velx", channel->vel_x, n * sizeof(float));
+    snapshot_put(file, "ch.vely", channel->vel_y, n * sizeof(float));
+    snapshot_put(file, "ch.shad", channel->shadowing_db, n * sizeof(float));
+    snapshot_put(file, "ch.shrho", channel->shadowing_rho, n * sizeof(float));
+    snapshot_put(file, "ch.shinn", channel->shadowing_innov, n * sizeof(float));
+    snapshot_put(file, "ch.fdre", channel->fading_re, n * sizeof(float));
+    snapshot_put(file, "ch.fdim", channel->fading_im, n * sizeof(float));
+    snapshot_put(file, "ch.fdrho", channel->fading_rho, n * sizeof(float));
+    snapshot_put(file, "ch.fdinn", channel->fading_innov, n * sizeof(float));
+    snapshot_put(file, "ch.rng", channel->rng, n * sizeof(uint32_t));
+    snapshot_put(file, "ch.sinr", channel->sinr_db, n * sizeof(float));
+    snapshot_put(file, "ch.cqi", channel->cqi, n * sizeof(uint8_t));
+    snapshot_put(file, "ch.mcs", channel->mcs, n * sizeof(uint8_t));
+}
+
+// channel must already be initialized for the same number of UEs
+static inline void snapshot_get_channel(FILE *file, ChannelModel *channel) {
+    size_t n = channel->num_ues;
+    int num_ues;
+    snapshot_get(file, "ch.ues", &num_ues, sizeof(num_ues));
+    if (num_ues != channel->num_ues) {
+        fprintf(stderr, "Snapshot has %d UEs, scenario has %d\n", num_ues, channel->num_ues);
+        exit(EXIT_FAILURE);
+    }
+    snapshot_get(file, "ch.posx", channel->pos_x, n * sizeof(float));
+    snapshot_get(file, "ch.posy", channel->pos_y, n * sizeof(float));
+    snapshot_get(file, "ch.velx", channel->vel_x, n * sizeof(float));
+    snapshot_get(file, "ch.vely", channel->vel_y, n * sizeof(float));
+    snapshot_get(file, "ch.shad", channel->shadowing_db, n * sizeof(float));
+    snapshot_get(file, "ch.shrho", channel->shadowing_rho, n * sizeof(float));
+    snapshot_get(file, "ch.shinn", channel->shadowing_innov, n * sizeof(float));
+    snapshot_get(file, "ch.fdre", channel->fading_re, n * sizeof(float));
+    snapshot_get(file, "ch.fdim", channel->fading_im, n * sizeof(float));
+    snapshot_get(file, "ch.fdrho", channel->fading_rho, n * sizeof(float));
+    snapshot_get(file, "ch.fdinn", channel->fading_innov, n * sizeof(float));
+    snapshot_get(file, "ch.rng", channel->rng, n * sizeof(uint32_t));
+    snapshot_get(file, "ch.sinr", channel->sinr_db, n * sizeof(float));
+    snapshot_get(file, "ch.cqi", channel->cqi, n * sizeof(uint8_t));
+    snapshot_get(file, "ch.mcs", channel->mcs, n * sizeof(uint8_t));
+}
+
+// Only the items in the heap, in heap order, and their keys; positions are rebuilt on load.
+// tag names the items section; the size and keys go in tag.n and tag.k (tag up to 5 chars)
+static inline void snapshot_put_heap(FILE *file, const char *tag, const IndexedHeap *heap) {
+    char name[8];
+    snprintf(name, sizeof(name), "%.5s.n", tag);
+    snapshot_put(file, name, &heap->size, sizeof(heap->size));
+    snapshot_put(file, tag, heap->items, heap->size * sizeof(int));
+
+    double *keys = malloc((heap->size > 0 ? heap->size : 1) * sizeof(double));
+    for (int i = 0; i < heap->size; i++) {
+        keys[i] = heap->key[heap->items[i]];
+    }
+    snprintf(name, sizeof(name), "%.5s.k", tag);
+    snapshot_put(file, name, keys, heap->size * sizeof(double));
+    free(keys);
+}
+
+static inline void snapshot_get_heap(FILE *file, const char *tag, IndexedHeap *heap) {
+    char name[8];
+    int size;
+    snprintf(name, sizeof(name), "%.5s.n", tag);
+    snapshot_get(file, name, &size, sizeof(size));
+    if (size < 0 || size > heap->capacity) {
+        fprintf(stderr, "Snapshot heap '%s' does not fit (%d items)\n", tag, size);
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < heap->capacity; i++) {
+        heap->position[i] = -1;
+    }
+    heap->size = size;
+    snapshot_get(file, tag, heap->items, size * sizeof(int));
+
+    double *keys = malloc((size > 0 ? size : 1) * sizeof(double));
+    snprintf(name, sizeof(name), "%.5s.k", tag);
+    snapshot_get(file, name, keys, size * sizeof(double));
+    for (int i = 0; i < size; i++) {
+        int item = heap->items[i];
+        if (item < 0 || item >= heap->capacity || heap->position[item] >= 0) {
+            fprintf(stderr, "Snapshot heap '%s' holds an invalid item\n", tag);
+            exit(EXIT_FAILURE);
+        }
+        heap->position[item] = i;
+        heap->key[item] = keys[i];
+    }
+    free(keys);
+}
+
+static inline void snapshot_close(FILE *file) {
+    if (fclose(file) != 0) {
+        perror("Failed to write snapshot");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Runs branch(index, out, context) for index 0..count-1, each in its own forked child with
+// out connected to a pipe, then copies the children's output to stdout in index order.
+// Returns the number of branches that failed.
+static inline int snapshot_branch(int count, void (*branch)(int index, FILE *out, void *context), void *context) {
+    pid_t children[SNAPSHOT_MAX_BRANCHES];
+    FILE *outputs[SNAPSHOT_MAX_BRANCHES];
+    if (count > SNAPSHOT_MAX_BRANCHES) {
+        fprintf(stderr, "At most %d branches\n", SNAPSHOT_MAX_BRANCHES);
+        exit(EXIT_FAILURE);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < count; i++) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0) {
+            perror("Failed to create branch pipe");
+            exit(EXIT_FAILURE);
+        }
+        children[i] = fork();
+        if (children[i] < 0) {
+            perror("Failed to fork branch");
+            exit(EXIT_FAILURE);
+        }
+        if (children[i] == 0) {
+            close(pipe_fds[0]);
+            FILE *out = fdopen(pipe_fds[1], "w");
+            branch(i, out, context);
+            fclose(out);
+            _exit(EXIT_SUCCESS);
+        }
+        close(pipe_fds[1]);
+        outputs[i] = fdopen(pipe_fds[0], "r");
+    }
+
+    // Drain in order: a child blocks on a full pipe until its turn comes
+    int failed = 0;
+    char buffer[4096];
+    for (int i = 0; i < count; i++) {
+        size_t bytes;
+        while ((bytes = fread(buffer, 1, sizeof(buffer), outputs[i])) > 0) {
+            fwrite(buffer, 1, bytes, stdout);
+        }
+        fclose(outputs[i]);
+        int status;
+        waitpid(children[i], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            failed++;
+        }
+    }
+    fflush(stdout);
+    return failed;
+}
+
+#endif
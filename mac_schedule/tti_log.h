@@ -0,0 +1,208 @@
+#ifndef TTI_LOG_H
+#define TTI_LOG_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Per-TTI decision log written by a background thread.
+// The TTI loop fills a chunk of TTI_LOG_CHUNK_ROWS rows column by column; a full chunk
+// is handed to the writer through a single-producer/single-consumer ring and an empty
+// one is taken from a second ring. Neither side takes a lock, and the TTI loop never
+// waits on the disk: if the writer falls behind, another chunk is allocated.
+// After a write error the writer only recycles chunks; tti_log_close() reports it.
+//
+// File layout: "TTIL", uint32 version, then chunks of
+//   uint32 rows, uint16 cell[rows], uint32 tti[rows], uint32 user_id[rows],
+//   uint16 rbs[rows], uint8 mcs[rows], uint32 bytes[rows]
+
+#define TTI_LOG_MAGIC "TTIL"
+#define TTI_LOG_VERSION 1
+#define TTI_LOG_CHUNK_ROWS 65536
+#define TTI_LOG_RING_SIZE 256           // power of two
+#define TTI_LOG_PREALLOCATED_CHUNKS 8
+#define TTI_LOG_IDLE_SLEEP_NS 200000
+
+typedef struct {
+    uint32_t rows;
+    uint16_t cell[TTI_LOG_CHUNK_ROWS];
+    uint32_t tti[TTI_LOG_CHUNK_ROWS];
+    uint32_t user_id[TTI_LOG_CHUNK_ROWS];
+    uint16_t rbs[TTI_LOG_CHUNK_ROWS];
+    uint8_t mcs[TTI_LOG_CHUNK_ROWS];
+    uint32_t bytes[TTI_LOG_CHUNK_ROWS];
+} TtiLogChunk;
+
+typedef struct {
+    TtiLogChunk *slots[TTI_LOG_RING_SIZE];
+    _Atomic size_t head;    // next slot to read
+    _Atomic size_t tail;    // next slot to write
+} TtiLogRing;
+
+typedef struct {
+    FILE *file;
+    pthread_t writer;
+    atomic_int closing;
+    TtiLogRing full;
+    TtiLogRing empty;
+    TtiLogChunk *current;
+    int chunks_allocated;
+    long long rows_written;
+    int failed;             // set by the writer on a write error
+} TtiLog;
+
+static inline int tti_log_ring_push(TtiLogRing *ring, TtiLogChunk *chunk) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == TTI_LOG_RING_SIZE) {
+        return 0;
+    }
+    ring->slots[tail & (TTI_LOG_RING_SIZE - 1)] = chunk;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+static inline TtiLogChunk *tti_log_ring_pop(TtiLogRing *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire)) {
+        return NULL;
+    }
+    TtiLogChunk *chunk = ring->slots[head & (TTI_LOG_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return chunk;
+}
+
+static inline TtiLogChunk *tti_log_new_chunk(TtiLog *log) {
+    TtiLogChunk *chunk = malloc(sizeof(TtiLogChunk));
+    if (chunk == NULL) {
+        perror("Failed to allocate TTI log chunk");
+        exit(EXIT_FAILURE);
+    }
+    log->chunks_allocated++;
+    return chunk;
+}
+
+// Returns 0 if any part of the chunk could not be written
+static inline int tti_log_write_chunk(FILE *file, const TtiLogChunk *chunk) {
+    uint32_t rows = chunk->rows;
+    return fwrite(&rows, sizeof(rows), 1, file) == 1 &&
+           fwrite(chunk->cell, sizeof(chunk->cell[0]), rows, file) == rows &&
+           fwrite(chunk->tti, sizeof(chunk->tti[0]), rows, file) == rows &&
+           fwrite(chunk->user_id, sizeof(chunk->user_id[0]), rows, file) == rows &&
+           fwrite(chunk->rbs, sizeof(chunk->rbs[0]), rows, file) == rows &&
+           fwrite(chunk->mcs, sizeof(chunk->mcs[0]), rows, file) == rows &&
+           fwrite(chunk->bytes, sizeof(chunk->bytes[0]), rows, file) == rows;
+}
+
+static void *tti_log_writer(void *arg) {
+    TtiLog *log = (TtiLog *)arg;
+    struct timespec idle = {0, TTI_LOG_IDLE_SLEEP_NS};
+
+    while (1) {
+        TtiLogChunk *chunk = tti_log_ring_pop(&log->full);
+        if (chunk == NULL) {
+            // closing is set after the last push, so one more pop after seeing it drains the ring
+            if (atomic_load(&log->closing) && (chunk = tti_log_ring_pop(&log->full)) == NULL) {
+                break;
+            }
+            if (chunk == NULL) {
+                nanosleep(&idle, NULL);
+                continue;
+            }
+        }
+        if (!log->failed && !tti_log_write_chunk(log->file, chunk)) {
+            perror("Failed to write TTI log");
+            log->failed = 1;
+        }
+        chunk->rows = 0;
+        if (!tti_log_ring_push(&log->empty, chunk)) {
+            free(chunk);
+        }
+    }
+    return NULL;
+}
+
+static inline TtiLog *tti_log_open(const char *path) {
+    TtiLog *log = calloc(1, sizeof(TtiLog));
+    log->file = fopen(path, "wb");
+    if (log->file == NULL) {
+        perror("Failed to open TTI log");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t version = TTI_LOG_VERSION;
+    if (fwrite(TTI_LOG_MAGIC, 1, 4, log->file) != 4 || fwrite(&version, sizeof(version), 1, log->file) != 1) {
+        perror("Failed to write TTI log");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < TTI_LOG_PREALLOCATED_CHUNKS; i++) {
+        TtiLogChunk *chunk = tti_log_new_chunk(log);
+        chunk->rows = 0;
+        tti_log_ring_push(&log->empty, chunk);
+    }
+    log->current = tti_log_ring_pop(&log->empty);
+
+    if (pthread_create(&log->writer, NULL, tti_log_writer, log) != 0) {
+        perror("Failed to start TTI log writer");
+        exit(EXIT_FAILURE);
+    }
+    return log;
+}
+
+// Hands the current chunk to the writer and picks up an empty one
+static inline void tti_log_flush(TtiLog *log) {
+    struct timespec idle = {0, TTI_LOG_IDLE_SLEEP_NS};
+    while (!tti_log_ring_push(&log->full, log->current)) {
+        // Only reachable with TTI_LOG_RING_SIZE chunks queued, i.e. the disk cannot keep up at all
+        nanosleep(&idle, NULL);
+    }
+    log->current = tti_log_ring_pop(&log->empty);
+    if (log->current == NULL) {
+        log->current = tti_log_new_chunk(log);
+        log->current->rows = 0;
+    }
+}
+
+static inline void tti_log_append(TtiLog *log, int cell, int tti, int user_id, int rbs, int mcs, int bytes) {
+    TtiLogChunk *chunk = log->current;
+    uint32_t row = chunk->rows++;
+    chunk->cell[row] = (uint16_t)cell;
+    chunk->tti[row] = (uint32_t)tti;
+    chunk->user_id[row] = (uint32_t)user_id;
+    chunk->rbs[row] = (uint16_t)rbs;
+    chunk->mcs[row] = (uint8_t)mcs;
+    chunk->bytes[row] = (uint32_t)bytes;
+    log->rows_written++;
+    if (chunk->rows == TTI_LOG_CHUNK_ROWS) {
+        tti_log_flush(log);
+    }
+}
+
+// Returns 1 if the whole log reached the file, 0 if it is incomplete
+static inline int tti_log_close(TtiLog *log) {
+    if (log->current->rows > 0) {
+        tti_log_flush(log);
+    }
+    atomic_store(&log->closing, 1);
+    pthread_join(log->writer, NULL);
+    int complete = !log->failed && !ferror(log->file);
+    if (fclose(log->file) != 0) {
+        if (complete) {
+            perror("Failed to write TTI log");
+        }
+        complete = 0;
+    }
+
+    free(log->current);
+    TtiLogChunk *chunk;
+    while ((chunk = tti_log_ring_pop(&log->empty)) != NULL) {
+        free(chunk);
+    }
+    free(log);
+    return complete;
+}
+
+#endif
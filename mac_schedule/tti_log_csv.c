@@ -0,0 +1,53 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tti_log.h"
+
+// Converts a TTI log written by the simulators into CSV on stdout
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <tti_log_file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        perror("Failed to open TTI log");
+        return 1;
+    }
+
+    char magic[4];
+    uint32_t version;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, TTI_LOG_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, file) != 1 || version != TTI_LOG_VERSION) {
+        fprintf(stderr, "%s is not a version %d TTI log\n", argv[1], TTI_LOG_VERSION);
+        return 1;
+    }
+
+    TtiLogChunk *chunk = malloc(sizeof(TtiLogChunk));
+    printf("cell,tti,user_id,rbs,mcs,bytes\n");
+
+    uint32_t rows;
+    while (fread(&rows, sizeof(rows), 1, file) == 1) {
+        if (rows > TTI_LOG_CHUNK_ROWS ||
+            fread(chunk->cell, sizeof(chunk->cell[0]), rows, file) != rows ||
+            fread(chunk->tti, sizeof(chunk->tti[0]), rows, file) != rows ||
+            fread(chunk->user_id, sizeof(chunk->user_id[0]), rows, file) != rows ||
+            fread(chunk->rbs, sizeof(chunk->rbs[0]), rows, file) != rows ||
+            fread(chunk->mcs, sizeof(chunk->mcs[0]), rows, file) != rows ||
+            fread(chunk->bytes, sizeof(chunk->bytes[0]), rows, file) != rows) {
+            fprintf(stderr, "Truncated chunk in %s\n", argv[1]);
+            return 1;
+        }
+        for (uint32_t i = 0; i < rows; i++) {
+            printf("%u,%u,%u,%u,%u,%u\n", chunk->cell[i], chunk->tti[i], chunk->user_id[i],
+                   chunk->rbs[i], chunk->mcs[i], chunk->bytes[i]);
+        }
+    }
+
+    free(chunk);
+    fclose(file);
+    return 0;
+}
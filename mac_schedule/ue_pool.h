@@ -0,0 +1,117 @@
+#ifndef UE_POOL_H
+#define UE_POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Pool of UE slots stored one array per field.
+// Released slots go on a free list and are reused by the next arrival; the arrays only
+// grow (by doubling) when the free list is empty, so steady-state session churn does
+// no heap work. Live slots are also kept in a dense active[] list so schedulers walk
+// num_active entries instead of the whole capacity.
+
+typedef struct {
+    int capacity;
+    int num_active;
+    int free_head;
+    int *next_free;     // free-list link, -1 terminates
+    int *active;        // dense list of live slots
+    int *active_pos;    // slot -> index in active[], -1 when free
+
+    int *user_id;
+    int *mcs_index;
+    int *total_resource_blocks;
+    int *times_scheduled;
+    long long *total_data_transmitted;
+    int *last_scheduled_tti;
+    int *arrival_tti;
+    int *departure_tti;
+} UEPool;
+
+static inline void *ue_pool_resize(void *ptr, int capacity, size_t size) {
+    void *resized = realloc(ptr, (size_t)capacity * size);
+    if (resized == NULL) {
+        perror("Failed to grow UE pool");
+        exit(EXIT_FAILURE);
+    }
+    return resized;
+}
+
+static inline void ue_pool_grow(UEPool *pool, int capacity) {
+    pool->next_free = ue_pool_resize(pool->next_free, capacity, sizeof(int));
+    pool->active = ue_pool_resize(pool->active, capacity, sizeof(int));
+    pool->active_pos = ue_pool_resize(pool->active_pos, capacity, sizeof(int));
+    pool->user_id = ue_pool_resize(pool->user_id, capacity, sizeof(int));
+    pool->mcs_index = ue_pool_resize(pool->mcs_index, capacity, sizeof(int));
+    pool->total_resource_blocks = ue_pool_resize(pool->total_resource_blocks, capacity, sizeof(int));
+    pool->times_scheduled = ue_pool_resize(pool->times_scheduled, capacity, sizeof(int));
+    pool->total_data_transmitted = ue_pool_resize(pool->total_data_transmitted, capacity, sizeof(long long));
+    pool->last_scheduled_tti = ue_pool_resize(pool->last_scheduled_tti, capacity, sizeof(int));
+    pool->arrival_tti = ue_pool_resize(pool->arrival_tti, capacity, sizeof(int));
+    pool->departure_tti = ue_pool_resize(pool->departure_tti, capacity, sizeof(int));
+
+    // Chain the new slots onto the free list, lowest index first
+    for (int slot = capacity - 1; slot >= pool->capacity; slot--) {
+        pool->next_free[slot] = pool->free_head;
+        pool->active_pos[slot] = -1;
+        pool->free_head = slot;
+    }
+    pool->capacity = capacity;
+}
+
+static inline void ue_pool_init(UEPool *pool, int initial_capacity) {
+    *pool = (UEPool){0};
+    pool->free_head = -1;
+    ue_pool_grow(pool, initial_capacity > 0 ? initial_capacity : 1);
+}
+
+static inline void ue_pool_free(UEPool *pool) {
+    free(pool->next_free);
+    free(pool->active);
+    free(pool->active_pos);
+    free(pool->user_id);
+    free(pool->mcs_index);
+    free(pool->total_resource_blocks);
+    free(pool->times_scheduled);
+    free(pool->total_data_transmitted);
+    free(pool->last_scheduled_tti);
+    free(pool->arrival_tti);
+    free(pool->departure_tti);
+    *pool = (UEPool){0};
+}
+
+// Returns a zeroed live slot
+static inline int ue_pool_alloc(UEPool *pool) {
+    if (pool->free_head == -1) {
+        ue_pool_grow(pool, pool->capacity * 2);
+    }
+    int slot = pool->free_head;
+    pool->free_head = pool->next_free[slot];
+
+    pool->active_pos[slot] = pool->num_active;
+    pool->active[pool->num_active++] = slot;
+
+    pool->user_id[slot] = -1;
+    pool->mcs_index[slot] = 0;
+    pool->total_resource_blocks[slot] = 0;
+    pool->times_scheduled[slot] = 0;
+    pool->total_data_transmitted[slot] = 0;
+    pool->last_scheduled_tti[slot] = -1;
+    pool->arrival_tti[slot] = 0;
+    pool->departure_tti[slot] = 0;
+    return slot;
+}
+
+// Swap-removes the slot from the active list and puts it back on the free list
+static inline void ue_pool_release(UEPool *pool, int slot) {
+    int pos = pool->active_pos[slot];
+    int last = pool->active[--pool->num_active];
+    pool->active[pos] = last;
+    pool->active_pos[last] = pos;
+    pool->active_pos[slot] = -1;
+
+    pool->next_free[slot] = pool->free_head;
+    pool->free_head = slot;
+}
+
+#endif
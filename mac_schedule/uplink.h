@@ -0,0 +1,309 @@
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "channel_model.h"
+#include "scenario.h"
+#include "scheduler_policy.h"
+
+// Uplink scheduling from buffer status (BSR) and power headroom (PHR) reports.
+//
+// The scheduler never sees a UE's buffer or path loss directly. Every bsr_period TTIs a UE
+// reports its buffer, rounded up to a short-BSR level, and every phr_period TTIs its power
+// headroom for one RB under fractional power control:
+//   phr = P_CMAX - (P0 + alpha * PL)
+// so it can use 10^(phr/10) RBs before it runs out of power. Between reports the scheduler
+// subtracts what it has granted from the reported buffer.
+//
+// Each grant is one contiguous run of RBs (single-carrier FDMA). Free spectrum is a short
+// list of intervals between the PUCCH regions at the band edges and the PRACH occasion;
+// UEs go in PF order, each asks for just enough RBs for its buffer within its power limit,
+// and takes the best-fitting free interval (the smallest that holds it, otherwise the
+// largest there is).
+//
+// Path loss comes from the downlink ChannelModel (reciprocal channel); the per-RB SINR a
+// UE reaches is P0 - (1 - alpha) * PL - noise while it has headroom.
+
+#define UPLINK_MAX_RB SCENARIO_MAX_RB
+#define UPLINK_P_CMAX_DBM 23.0f
+#define UPLINK_P0_DBM -90.0f
+#define UPLINK_ALPHA 0.8f
+#define UPLINK_NOISE_PER_RB_DBM -116.4f    // -174 dBm/Hz + 10log10(180 kHz) + 5 dB noise figure
+#define UPLINK_PUCCH_RBS 2                 // at each band edge
+#define UPLINK_PRACH_RBS 6
+#define UPLINK_PRACH_PERIOD 10
+#define UPLINK_PACKET_BYTES 300
+#define UPLINK_BSR_LEVELS 32
+#define UPLINK_BSR_MAX_BYTES 150000.0f
+#define UPLINK_MAX_INTERVALS 4
+#define UPLINK_AVERAGING_TTIS 100.0f
+
+typedef struct {
+    int start;
+    int length;
+} RbInterval;
+
+typedef struct {
+    int num_ues;
+    int resource_blocks;
+    uint32_t rng;
+    float bsr_levels[UPLINK_BSR_LEVELS];    // upper bound of each level in bytes
+    float arrival_probability;              // per UE and TTI, one packet of UPLINK_PACKET_BYTES
+
+    // UE side
+    int *buffer;
+    float *coupling_loss_db;
+
+    // Scheduler side
+    int *reported_buffer;
+    float *headroom_db;
+    float *average_rate;
+
+    // Grants of the current TTI, in PF order
+    int num_grants;
+    int *grant_ue;
+    int *grant_start;
+    int *grant_blocks;
+    int *grant_mcs;
+    int *grant_bytes;
+    float *keys;
+
+    long long bytes_sent;
+    long long bytes_padding;
+    long long blocks_granted;
+    long long power_limited_grants;
+    long long total_grants;
+} UplinkState;
+
+static inline void uplink_init(UplinkState *ul, int num_ues, int resource_blocks, int max_grants, double kbps, uint32_t seed) {
+    ul->num_ues = num_ues;
+    ul->resource_blocks = resource_blocks;
+    ul->rng = seed ^ 0x5851F42Du ? seed ^ 0x5851F42Du : 1;
+    for (int k = 0; k < UPLINK_BSR_LEVELS; k++) {
+        ul->bsr_levels[k] = k == 0 ? 0.0f : 10.0f * powf(UPLINK_BSR_MAX_BYTES / 10.0f, (k - 1) / (float)(UPLINK_BSR_LEVELS - 2));
+    }
+    ul->arrival_probability = (float)(kbps * 1000.0 / 8.0 * CHANNEL_TTI_S / UPLINK_PACKET_BYTES);
+
+    ul->buffer = channel_alloc(num_ues, sizeof(int));
+    ul->coupling_loss_db = channel_alloc(num_ues, sizeof(float));
+    ul->reported_buffer = channel_alloc(num_ues, sizeof(int));
+    ul->headroom_db = channel_alloc(num_ues, sizeof(float));
+    ul->average_rate = channel_alloc(num_ues, sizeof(float));
+    ul->grant_ue = channel_alloc(max_grants, sizeof(int));
+    ul->grant_start = channel_alloc(max_grants, sizeof(int));
+    ul->grant_blocks = channel_alloc(max_grants, sizeof(int));
+    ul->grant_mcs = channel_alloc(max_grants, sizeof(int));
+    ul->grant_bytes = channel_alloc(max_grants, sizeof(int));
+    ul->keys = channel_alloc(max_grants, sizeof(float));
+    for (int i = 0; i < num_ues; i++) {
+        ul->buffer[i] = 0;
+        ul->coupling_loss_db[i] = 0;
+        ul->reported_buffer[i] = 0;
+        ul->headroom_db[i] = 0;
+        ul->average_rate[i] = 1.0f;
+    }
+    ul->num_grants = 0;
+    ul->bytes_sent = 0;
+    ul->bytes_padding = 0;
+    ul->blocks_granted = 0;
+    ul->power_limited_grants = 0;
+    ul->total_grants = 0;
+}
+
+static inline void uplink_free(UplinkState *ul) {
+    free(ul->buffer);
+    free(ul->coupling_loss_db);
+    free(ul->reported_buffer);
+    free(ul->headroom_db);
+    free(ul->average_rate);
+    free(ul->grant_ue);
+    free(ul->grant_start);
+    free(ul->grant_blocks);
+    free(ul->grant_mcs);
+    free(ul->grant_bytes);
+    free(ul->keys);
+}
+
+// Smallest BSR level bound that covers bytes
+static inline int uplink_bsr_quantize(const UplinkState *ul, int bytes) {
+    int low = 0, high = UPLINK_BSR_LEVELS - 1;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (ul->bsr_levels[mid] >= bytes) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return (int)ceilf(ul->bsr_levels[low]);
+}
+
+static inline int uplink_sinr_to_mcs(float sinr_db) {
+    int q = 0;
+    for (int k = 0; k < CQI_COUNT - 1; k++) {
+        q += sinr_db >= cqi_sinr_threshold_db[k];
+    }
+    return cqi_to_mcs[q];
+}
+
+// Takes the new path loss from the downlink channel and adds this TTI's packet arrivals
+static inline void uplink_step(UplinkState *ul, const ChannelModel *channel) {
+    const float *restrict sinr_db = channel->sinr_db;
+    float *restrict coupling_loss = ul->coupling_loss_db;
+    for (int i = 0; i < ul->num_ues; i++) {
+        coupling_loss[i] = CHANNEL_TX_POWER_DBM - CHANNEL_NOISE_INTERFERENCE_DBM - sinr_db[i];
+    }
+    for (int i = 0; i < ul->num_ues; i++) {
+        if (channel_rng_uniform(&ul->rng) < ul->arrival_probability) {
+            ul->buffer[i] += UPLINK_PACKET_BYTES;
+        }
+    }
+}
+
+// UEs report on staggered TTIs: UE i sends its BSR when (tti + i) % bsr_period == 0
+static inline void uplink_reports(UplinkState *ul, int tti, int bsr_period, int phr_period) {
+    for (int i = 0; i < ul->num_ues; i++) {
+        if ((tti + i) % bsr_period == 0) {
+            ul->reported_buffer[i] = ul->buffer[i] > 0 ? uplink_bsr_quantize(ul, ul->buffer[i]) : 0;
+        }
+        if ((tti + i) % phr_period == 0) {
+            ul->headroom_db[i] = UPLINK_P_CMAX_DBM - (UPLINK_P0_DBM + UPLINK_ALPHA * ul->coupling_loss_db[i]);
+        }
+    }
+}
+
+// Free spectrum of a TTI: the band between the PUCCH edges, split by the PRACH occasion
+static inline int uplink_free_intervals(const UplinkState *ul, int tti, RbInterval *intervals) {
+    int first = UPLINK_PUCCH_RBS;
+    int last = ul->resource_blocks - UPLINK_PUCCH_RBS;
+    int count = 0;
+    if (last <= first) {
+        return 0;
+    }
+    if (tti % UPLINK_PRACH_PERIOD == 0 && last - first > UPLINK_PRACH_RBS) {
+        int prach = first + (last - first - UPLINK_PRACH_RBS) / 2;
+        intervals[count++] = (RbInterval){first, prach - first};
+        intervals[count++] = (RbInterval){prach + UPLINK_PRACH_RBS, last - prach - UPLINK_PRACH_RBS};
+    } else {
+        intervals[count++] = (RbInterval){first, last - first};
+    }
+    return count;
+}
+
+// Smallest free interval of at least blocks RBs, or the largest one if none is that big
+static inline int uplink_best_fit(const RbInterval *intervals, int count, int blocks) {
+    int best = -1;
+    int largest = -1;
+    for (int k = 0; k < count; k++) {
+        int length = intervals[k].length;
+        if (length >= blocks && (best < 0 || length < intervals[best].length)) {
+            best = k;
+        }
+        if (length > 0 && (largest < 0 || length > intervals[largest].length)) {
+            largest = k;
+        }
+    }
+    return best >= 0 ? best : largest;
+}
+
+// MCS the scheduler expects from the UE's last PHR, and how many RBs its power allows
+static inline int uplink_link(const UplinkState *ul, int ue, int *max_blocks) {
+    float estimated_loss = (UPLINK_P_CMAX_DBM - ul->headroom_db[ue] - UPLINK_P0_DBM) / UPLINK_ALPHA;
+    float power_blocks = powf(10.0f, ul->headroom_db[ue] / 10.0f);
+    if (power_blocks < 1.0f) {
+        // Out of headroom even on one RB: full power, lower SINR
+        *max_blocks = 1;
+        return uplink_sinr_to_mcs(UPLINK_P_CMAX_DBM - estimated_loss - UPLINK_NOISE_PER_RB_DBM);
+    }
+    *max_blocks = power_blocks >= UPLINK_MAX_RB ? UPLINK_MAX_RB : (int)power_blocks;
+    return uplink_sinr_to_mcs(UPLINK_P0_DBM - (1.0f - UPLINK_ALPHA) * estimated_loss - UPLINK_NOISE_PER_RB_DBM);
+}
+
+// Fewest RBs at this MCS whose TBS covers bytes, at most max_blocks (TBS grows with RBs)
+static inline int uplink_blocks_for(int tbs[][UPLINK_MAX_RB + 1], int mcs, int bytes, int max_blocks) {
+    int low = 1, high = max_blocks;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (tbs[mcs][mid] >= bytes) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+// Builds this TTI's grants: up to max_grants UEs in PF order, one contiguous RB run each
+static inline int uplink_schedule(UplinkState *ul, int tti, int max_grants, int tbs[][UPLINK_MAX_RB + 1]) {
+    int n = ul->num_ues;
+    int *selected = ul->grant_ue;
+    float *keys = ul->keys;
+    int found = 0;
+
+    // PF over UEs with data reported, on the rate their power allows
+    for (int i = 0; i < n; i++) {
+        if (ul->reported_buffer[i] <= 0) {
+            continue;
+        }
+        int max_blocks;
+        int mcs = uplink_link(ul, i, &max_blocks);
+        float key = tbs[mcs][max_blocks] / ul->average_rate[i];
+        scheduler_top_k_float(key, i, max_grants, &found, keys, selected);
+    }
+
+    RbInterval intervals[UPLINK_MAX_INTERVALS];
+    int num_intervals = uplink_free_intervals(ul, tti, intervals);
+    int granted = 0;
+    for (int s = 0; s < found; s++) {
+        int ue = selected[s];
+
+        int max_blocks;
+        int mcs = uplink_link(ul, ue, &max_blocks);
+        int wanted = uplink_blocks_for(tbs, mcs, ul->reported_buffer[ue], max_blocks);
+
+        int k = uplink_best_fit(intervals, num_intervals, wanted);
+        if (k < 0) {
+            break;
+        }
+        int blocks = wanted < intervals[k].length ? wanted : intervals[k].length;
+        ul->grant_ue[granted] = ue;
+        ul->grant_start[granted] = intervals[k].start;
+        ul->grant_blocks[granted] = blocks;
+        ul->grant_mcs[granted] = mcs;
+        ul->grant_bytes[granted] = tbs[mcs][blocks];
+        intervals[k].start += blocks;
+        intervals[k].length -= blocks;
+
+        ul->power_limited_grants += tbs[mcs][max_blocks] < ul->reported_buffer[ue];
+        ul->reported_buffer[ue] -= tbs[mcs][blocks];
+        if (ul->reported_buffer[ue] < 0) {
+            ul->reported_buffer[ue] = 0;
+        }
+        ul->blocks_granted += blocks;
+        granted++;
+    }
+    ul->num_grants = granted;
+    ul->total_grants += granted;
+    return granted;
+}
+
+// UEs send on their grants; unused grant bytes are padding
+static inline void uplink_transmit(UplinkState *ul) {
+    for (int i = 0; i < ul->num_ues; i++) {
+        ul->average_rate[i] *= 1.0f - 1.0f / UPLINK_AVERAGING_TTIS;
+    }
+    for (int g = 0; g < ul->num_grants; g++) {
+        int ue = ul->grant_ue[g];
+        int bytes = ul->grant_bytes[g];
+        int sent = bytes < ul->buffer[ue] ? bytes : ul->buffer[ue];
+        ul->buffer[ue] -= sent;
+        ul->bytes_sent += sent;
+        ul->bytes_padding += bytes - sent;
+        ul->average_rate[ue] += sent / UPLINK_AVERAGING_TTIS;
+    }
+}
+
+#endif